@@ -0,0 +1,502 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/asset_cache.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "src/glyph_atlas.h"
+#include "src/sprite_atlas.h"
+
+namespace {
+    using irrklang::ik_c8;
+    using irrklang::ik_s32;
+    using irrklang::ik_u32;
+
+    // A file of the asset pack, read by irrKlang.
+    class PackFileReader : public irrklang::IFileReader {
+     public:
+        PackFileReader(const ik_c8* name, const void* data, ik_s32 size)
+            : name(name), data(static_cast<const char*>(data)), size(size),
+              position(0) { }
+
+        ik_s32 read(void* buffer, ik_u32 bytes) {
+            ik_s32 n = static_cast<ik_s32>(
+                    std::min<int64_t>(bytes, size - position));
+            std::memcpy(buffer, data + position, n);
+            position += n;
+            return n;
+        }
+
+        bool seek(ik_s32 target, bool relative) {
+            int64_t to = relative ? int64_t(position) + target : target;
+            if (to < 0 || to > size)
+                return false;
+            position = static_cast<ik_s32>(to);
+            return true;
+        }
+
+        ik_s32 getSize() { return size; }
+        ik_s32 getPos() { return position; }
+        const ik_c8* getFileName() { return name.c_str(); }
+
+     private:
+        std::string name;
+        const char* data;
+        ik_s32 size;
+        ik_s32 position;
+    };
+
+    // Opens the files irrKlang asks for from the pack. Those it doesn't
+    // have are left to irrKlang's own file access.
+    class PackFileFactory : public irrklang::IFileFactory {
+     public:
+        explicit PackFileFactory(const AssetPack& pack) : pack(pack) { }
+
+        irrklang::IFileReader* createFileReader(const ik_c8* filename) {
+            const AssetPack::Entry* entry = pack.find(filename);
+            if (entry == nullptr || entry->format != AssetPack::RAW)
+                return nullptr;
+            return new PackFileReader(filename, pack.data(*entry),
+                    static_cast<ik_s32>(entry->size));
+        }
+
+     private:
+        const AssetPack& pack;
+    };
+}
+
+TTF_Font* AssetCache::font(const std::string& path, int size) {
+    return static_cast<TTF_Font*>(get(FONT, path, size, nullptr));
+}
+
+GlyphAtlas* AssetCache::glyphs(const std::string& path, int size,
+        SDL_Renderer* renderer) {
+    return static_cast<GlyphAtlas*>(get(GLYPHS, path, size, renderer));
+}
+
+SDL_Texture* AssetCache::texture(const std::string& path,
+        SDL_Renderer* renderer) {
+    return static_cast<SDL_Texture*>(get(TEXTURE, path, 0, renderer));
+}
+
+SpriteAtlas* AssetCache::sprites(const std::string& descriptor,
+        SDL_Renderer* renderer) {
+    return static_cast<SpriteAtlas*>(get(SPRITES, descriptor, 0, renderer));
+}
+
+irrklang::ISoundEngine* AssetCache::sound_engine() {
+    return static_cast<irrklang::ISoundEngine*>(
+            get(SOUND_ENGINE, "", 0, nullptr));
+}
+
+irrklang::ISoundSource* AssetCache::sound(const std::string& path) {
+    return static_cast<irrklang::ISoundSource*>(get(SOUND, path, 0, nullptr));
+}
+
+void AssetCache::preload_font(const std::string& path, int size) {
+    queue(FONT, path, size, nullptr);
+}
+
+void AssetCache::preload_glyphs(const std::string& path, int size,
+        SDL_Renderer* renderer) {
+    queue(GLYPHS, path, size, renderer);
+}
+
+void AssetCache::preload_texture(const std::string& path,
+        SDL_Renderer* renderer) {
+    queue(TEXTURE, path, 0, renderer);
+}
+
+void AssetCache::preload_sprites(const std::string& descriptor,
+        SDL_Renderer* renderer) {
+    queue(SPRITES, descriptor, 0, renderer);
+}
+
+void AssetCache::preload_sound(const std::string& path) {
+    queue(SOUND, path, 0, nullptr);
+}
+
+void AssetCache::release(const void* asset) {
+    if (asset == nullptr)
+        return;
+    for (size_t i = 0; i < entries.size(); i++)
+        if (entries[i].asset == asset) {
+            if (entries[i].references > 0)
+                entries[i].references--;
+            return;
+        }
+}
+
+void AssetCache::trim() {
+    // Backwards, so that freeing a sound lets its device go too.
+    for (size_t i = entries.size(); i-- > 0; )
+        if (entries[i].references == 0) {
+            destroy(entries[i]);
+            entries.erase(entries.begin() + i);
+        }
+}
+
+void AssetCache::clear() {
+    // Keep what the worker already loaded, so that it is freed below.
+    stop_worker();
+    poll();
+    for (size_t i = 0; i < jobs.size(); i++)
+        delete jobs[i];
+    jobs.clear();
+
+    for (size_t i = entries.size(); i-- > 0; )
+        destroy(entries[i]);
+    entries.clear();
+    queued = finished = 0;
+}
+
+bool AssetCache::poll() {
+    // Jobs run in order, so the finished ones come first.
+    for (;;) {
+        Job* job = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(job_lock);
+            if (!jobs.empty() && jobs.front()->done) {
+                job = jobs.front();
+                jobs.pop_front();
+            }
+        }
+        if (job == nullptr)
+            break;
+        StartupTrace::Clock::time_point start = StartupTrace::Clock::now();
+        finish(job);
+        record("finish " + job->key, start);
+        delete job;
+        finished++;
+    }
+    return jobs.empty();
+}
+
+float AssetCache::progress() const {
+    return queued == 0 ? 1.0f : static_cast<float>(finished) / queued;
+}
+
+std::string AssetCache::make_key(Kind kind, const std::string& path,
+        int size) {
+    switch (kind) {
+        case FONT:
+            return "font:" + std::to_string(size) + ":" + path;
+        case GLYPHS:
+            return "glyphs:" + std::to_string(size) + ":" + path;
+        case TEXTURE:
+            return "texture:" + path;
+        case SPRITES:
+            return "sprites:" + path;
+        case SOUND_ENGINE:
+            return "sound_engine";
+        default:
+            return "sound:" + path;
+    }
+}
+
+void* AssetCache::get(Kind kind, const std::string& path, int size,
+        SDL_Renderer* renderer) {
+    std::string key = make_key(kind, path, size);
+    poll();
+    Entry* entry = lookup(key);
+    if (entry == nullptr) {
+        StartupTrace::Clock::time_point start = StartupTrace::Clock::now();
+        queue(kind, path, size, renderer);
+        wait();
+        record("wait " + key, start);
+        entry = lookup(key);
+    }
+    if (entry == nullptr)
+        return nullptr;
+    entry->references++;
+    return entry->asset;
+}
+
+AssetCache::Entry* AssetCache::lookup(const std::string& key) {
+    for (size_t i = 0; i < entries.size(); i++)
+        if (entries[i].key == key)
+            return &entries[i];
+    return nullptr;
+}
+
+void AssetCache::insert(Kind kind, const std::string& key, void* asset) {
+    Entry entry = { kind, key, asset, 0 };
+    entries.push_back(entry);
+}
+
+void AssetCache::queue(Kind kind, const std::string& path, int size,
+        SDL_Renderer* renderer) {
+    std::string key = make_key(kind, path, size);
+    if (lookup(key) != nullptr || pending(key))
+        return;
+
+    // SDL_ttf is initialized here, before the worker can use it. No font
+    // job can be running while it isn't.
+    if ((kind == FONT || kind == GLYPHS) && !TTF_WasInit()) {
+        StartupTrace::Clock::time_point start = StartupTrace::Clock::now();
+        TTF_Init();
+        record("TTF_Init", start);
+    }
+
+    // Sounds need the device first.
+    Entry* device = nullptr;
+    if (kind == SOUND) {
+        device = lookup(make_key(SOUND_ENGINE, "", 0));
+        if (device == nullptr)
+            queue(SOUND_ENGINE, "", 0, nullptr);
+    }
+
+    Job* job = new Job();
+    job->kind = kind;
+    job->key = key;
+    job->path = path;
+    job->size = size;
+    job->renderer = renderer;
+    job->engine = device != nullptr ?
+        static_cast<irrklang::ISoundEngine*>(device->asset) : nullptr;
+    job->asset = nullptr;
+    job->font = nullptr;
+    job->pixels = nullptr;
+    job->done = false;
+    jobs.push_back(job);
+    queued++;
+
+    {
+        std::lock_guard<std::mutex> lock(job_lock);
+        pending_jobs.push_back(job);
+    }
+    job_ready.notify_one();
+    if (!worker.joinable())
+        worker = std::thread(&AssetCache::work, this);
+}
+
+bool AssetCache::pending(const std::string& key) const {
+    for (size_t i = 0; i < jobs.size(); i++)
+        if (jobs[i]->key == key)
+            return true;
+    return false;
+}
+
+void AssetCache::wait() {
+    {
+        std::unique_lock<std::mutex> lock(job_lock);
+        while (!jobs.empty() && !jobs.back()->done && !stopping)
+            job_done.wait(lock);
+    }
+    poll();
+}
+
+void AssetCache::work() {
+    for (;;) {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(job_lock);
+            while (pending_jobs.empty() && !stopping)
+                job_ready.wait(lock);
+            if (stopping)
+                return;
+            job = pending_jobs.front();
+            pending_jobs.pop_front();
+        }
+        StartupTrace::Clock::time_point start = StartupTrace::Clock::now();
+        load(job);
+        record("load " + job->key, start);
+        {
+            std::lock_guard<std::mutex> lock(job_lock);
+            job->done = true;
+        }
+        job_done.notify_all();
+    }
+}
+
+void AssetCache::stop_worker() {
+    if (!worker.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(job_lock);
+        stopping = true;
+        pending_jobs.clear();
+    }
+    job_ready.notify_one();
+    worker.join();
+    stopping = false;
+}
+
+TTF_Font* AssetCache::open_font(const std::string& path, int size,
+        std::string* error) {
+    std::lock_guard<std::mutex> lock(font_lock);
+    SDL_RWops* packed = pack.open_rw(path);
+    TTF_Font* font = packed != nullptr ? TTF_OpenFontRW(packed, 1, size) :
+        TTF_OpenFont(path.c_str(), size);
+    if (font == nullptr)
+        *error = TTF_GetError();
+    return font;
+}
+
+void AssetCache::close_font(TTF_Font* font) {
+    std::lock_guard<std::mutex> lock(font_lock);
+    TTF_CloseFont(font);
+}
+
+void AssetCache::record(const std::string& name,
+        StartupTrace::Clock::time_point start) {
+    if (trace != nullptr)
+        trace->record(name, start);
+}
+
+// Everything that reads or decodes files, without touching the renderer.
+void AssetCache::load(Job* job) {
+    // SDL_image loads its decoders on first use. Do it up front, so that
+    // the trace tells it apart from the first image.
+    if ((job->kind == TEXTURE || job->kind == SPRITES) && !images_ready) {
+        StartupTrace::Clock::time_point start = StartupTrace::Clock::now();
+        IMG_Init(IMG_INIT_PNG);
+        record("IMG_Init", start);
+        images_ready = true;
+    }
+
+    switch (job->kind) {
+        case FONT:
+            job->asset = open_font(job->path, job->size, &job->error);
+            break;
+        case GLYPHS: {
+            job->font = open_font(job->path, job->size, &job->error);
+            if (job->font == nullptr)
+                break;
+            GlyphAtlas* atlas = new GlyphAtlas();
+            job->pixels = atlas->build_pixels(job->font);
+            job->asset = atlas;
+            break;
+        }
+        case TEXTURE:
+            // Pre-decoded images are uploaded as they are.
+            job->pixels = pack.find(job->path) != nullptr ?
+                pack.load_surface(job->path) : IMG_Load(job->path.c_str());
+            if (job->pixels == nullptr)
+                job->error = SDL_GetError();
+            break;
+        case SPRITES: {
+            SpriteAtlas* atlas = new SpriteAtlas();
+            job->pixels = atlas->load_pixels(job->path, &pack);
+            job->asset = atlas;
+            break;
+        }
+        case SOUND_ENGINE: {
+            irrklang::ISoundEngine* engine = irrklang::createIrrKlangDevice();
+            if (engine != nullptr && pack.is_open()) {
+                irrklang::IFileFactory* factory = new PackFileFactory(pack);
+                engine->addFileFactory(factory);
+                factory->drop();
+            }
+            job->asset = worker_device = engine;
+            break;
+        }
+        case SOUND: {
+            irrklang::ISoundEngine* engine =
+                job->engine != nullptr ? job->engine : worker_device;
+            if (engine != nullptr)
+                job->asset = engine->addSoundSourceFromFile(
+                        job->path.c_str(), irrklang::ESM_NO_STREAMING, true);
+            break;
+        }
+    }
+}
+
+// Uploads what load() produced and caches it.
+void AssetCache::finish(Job* job) {
+    switch (job->kind) {
+        case FONT:
+            if (job->asset == nullptr)
+                std::cerr << "cannot open font " << job->path << ": "
+                    << job->error << std::endl;
+            break;
+        case GLYPHS: {
+            // Keep the font too, unless it was cached meanwhile.
+            if (job->font == nullptr) {
+                std::cerr << "cannot open font " << job->path << ": "
+                    << job->error << std::endl;
+                break;
+            }
+            std::string font_key = make_key(FONT, job->path, job->size);
+            if (lookup(font_key) == nullptr)
+                insert(FONT, font_key, job->font);
+            else
+                close_font(job->font);
+            GlyphAtlas* atlas = static_cast<GlyphAtlas*>(job->asset);
+            if (!atlas->upload(job->pixels, job->renderer)) {
+                delete atlas;
+                job->asset = nullptr;
+            }
+            break;
+        }
+        case TEXTURE:
+            if (job->pixels != nullptr) {
+                job->asset = SDL_CreateTextureFromSurface(job->renderer,
+                        job->pixels);
+                if (job->asset == nullptr)
+                    job->error = SDL_GetError();
+                SDL_FreeSurface(job->pixels);
+            }
+            if (job->asset == nullptr)
+                std::cerr << "cannot load image " << job->path << ": "
+                    << job->error << std::endl;
+            break;
+        case SPRITES: {
+            SpriteAtlas* atlas = static_cast<SpriteAtlas*>(job->asset);
+            if (!atlas->upload(job->pixels, job->renderer)) {
+                delete atlas;
+                job->asset = nullptr;
+            }
+            break;
+        }
+        case SOUND_ENGINE:
+            if (job->asset == nullptr)
+                std::cerr << "cannot create sound device" << std::endl;
+            break;
+        case SOUND:
+            if (job->asset == nullptr) {
+                std::cerr << "cannot load sound " << job->path << std::endl;
+                break;
+            }
+            // The sound holds a reference to its device until it is freed.
+            if (Entry* device = lookup(make_key(SOUND_ENGINE, "", 0)))
+                device->references++;
+            break;
+    }
+    if (job->asset != nullptr)
+        insert(job->kind, job->key, job->asset);
+}
+
+void AssetCache::destroy(const Entry& entry) {
+    switch (entry.kind) {
+        case FONT:
+            close_font(static_cast<TTF_Font*>(entry.asset));
+            break;
+        case GLYPHS:
+            delete static_cast<GlyphAtlas*>(entry.asset);
+            break;
+        case TEXTURE:
+            SDL_DestroyTexture(static_cast<SDL_Texture*>(entry.asset));
+            break;
+        case SPRITES:
+            delete static_cast<SpriteAtlas*>(entry.asset);
+            break;
+        case SOUND_ENGINE:
+            static_cast<irrklang::ISoundEngine*>(entry.asset)->drop();
+            break;
+        case SOUND:
+            // Sounds come after the device in entries, it is still alive.
+            for (size_t i = 0; i < entries.size(); i++)
+                if (entries[i].kind == SOUND_ENGINE) {
+                    static_cast<irrklang::ISoundEngine*>(entries[i].asset)->
+                        removeSoundSource(
+                            static_cast<irrklang::ISoundSource*>(entry.asset));
+                    entries[i].references--;
+                }
+            break;
+    }
+}
@@ -0,0 +1,174 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_ASSET_CACHE_H_
+#define SRC_ASSET_CACHE_H_
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <irrKlang.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/asset_pack.h"
+#include "src/startup_trace.h"
+
+class GlyphAtlas;
+class SpriteAtlas;
+
+// Fonts, textures and sounds shared by the game states, keyed by path (and
+// point size for fonts). The first request loads an asset, later ones
+// return the same object, so switching states or starting a new game does
+// no file I/O.
+//
+// Every request takes a reference, to be given back with release().
+// Assets nobody holds stay loaded until trim() or clear(). Returns null
+// (and reports on stderr) when loading fails.
+//
+// With an asset pack open, files it contains are read from it instead of
+// the disk, including by irrKlang.
+//
+// Files are read and decoded on a worker thread; only texture uploads run
+// on the calling (render) thread. The preload functions queue assets ahead
+// of time, e.g. during the intro, and return at once. The getters block
+// until their asset is ready.
+class AssetCache {
+ public:
+    AssetCache() : trace(nullptr), worker_device(nullptr), images_ready(false),
+        queued(0), finished(0), stopping(false) { }
+    ~AssetCache() { clear(); }
+
+    // Serves assets from the pack at path, if there is one. Must be called
+    // before anything is loaded.
+    bool open_pack(const std::string& path) { return pack.open(path); }
+
+    // Records how long each asset takes to load, upload or wait for.
+    void set_trace(StartupTrace* trace) { this->trace = trace; }
+
+    TTF_Font* font(const std::string& path, int size);
+    // Glyphs of font(path, size), uploaded once.
+    GlyphAtlas* glyphs(const std::string& path, int size,
+            SDL_Renderer* renderer);
+    SDL_Texture* texture(const std::string& path, SDL_Renderer* renderer);
+    // Sprite sheets of a descriptor, see SpriteAtlas.
+    SpriteAtlas* sprites(const std::string& descriptor,
+            SDL_Renderer* renderer);
+
+    // irrKlang device shared by all sounds.
+    irrklang::ISoundEngine* sound_engine();
+    // Sound decoded into memory once (not streamed from disk), to be
+    // played with sound_engine()->play2D(source).
+    irrklang::ISoundSource* sound(const std::string& path);
+
+    // Gives back a reference taken by one of the functions above. Null is
+    // ignored.
+    void release(const void* asset);
+
+    // Queue an asset for the worker thread, if it isn't cached or queued
+    // yet. poll() finishes it; it is then cached, with no references.
+    void preload_font(const std::string& path, int size);
+    void preload_glyphs(const std::string& path, int size,
+            SDL_Renderer* renderer);
+    void preload_texture(const std::string& path, SDL_Renderer* renderer);
+    void preload_sprites(const std::string& descriptor,
+            SDL_Renderer* renderer);
+    void preload_sound(const std::string& path);
+
+    // Finishes (uploads) the assets the worker is done with. Call from the
+    // render thread. Returns true once nothing is left to load.
+    bool poll();
+    // Share of the queued assets finished so far, 1 when none are.
+    float progress() const;
+
+    // Frees the assets nobody holds.
+    void trim();
+    // Frees everything. Must run before the renderer is destroyed.
+    void clear();
+
+ private:
+    AssetCache(const AssetCache&);
+    AssetCache& operator=(const AssetCache&);
+
+    enum Kind { FONT, GLYPHS, TEXTURE, SPRITES, SOUND_ENGINE, SOUND };
+
+    struct Entry {
+        Kind kind;
+        std::string key;
+        void* asset;
+        int references;
+    };
+
+    // An asset being loaded. The worker fills in the results, poll()
+    // turns them into an entry.
+    struct Job {
+        Kind kind;
+        std::string key;
+        std::string path;
+        int size;
+        SDL_Renderer* renderer;
+        irrklang::ISoundEngine* engine;  // Device of a sound, if it exists.
+
+        void* asset;  // Font, atlas object, device or sound source.
+        TTF_Font* font;  // Font the glyphs were built from.
+        SDL_Surface* pixels;  // To be uploaded by poll().
+        std::string error;  // Why load() failed. SDL's is per thread.
+        bool done;  // Guarded by job_lock.
+    };
+
+    static std::string make_key(Kind kind, const std::string& path, int size);
+
+    // Cached asset of kind, loaded and waited for if necessary, with one
+    // more reference. Null if it cannot be loaded.
+    void* get(Kind kind, const std::string& path, int size,
+            SDL_Renderer* renderer);
+    Entry* lookup(const std::string& key);
+    void insert(Kind kind, const std::string& key, void* asset);
+    void destroy(const Entry& entry);
+
+    void queue(Kind kind, const std::string& path, int size,
+            SDL_Renderer* renderer);
+    bool pending(const std::string& key) const;
+    void wait();  // Until the worker is idle, then poll().
+    void work();  // Worker thread.
+    void load(Job* job);  // On the worker.
+    void finish(Job* job);  // On the render thread.
+    void stop_worker();
+
+    // FreeType faces are opened on the worker and closed on the render
+    // thread, one at a time.
+    TTF_Font* open_font(const std::string& path, int size,
+            std::string* error);
+    void close_font(TTF_Font* font);
+    void record(const std::string& name, StartupTrace::Clock::time_point start);
+
+    // In load order, so that an asset is freed before those it was built
+    // from (a sound before the device).
+    std::vector<Entry> entries;
+
+    // Outlives the entries: fonts keep reading from it.
+    AssetPack pack;
+
+    StartupTrace* trace;
+
+    // Unfinished jobs in queue order, owned by the render thread. The
+    // worker takes them from pending_jobs and runs them in the same order.
+    std::deque<Job*> jobs;
+    std::deque<Job*> pending_jobs;  // Guarded by job_lock.
+    irrklang::ISoundEngine* worker_device;  // Created by the worker.
+    bool images_ready;  // SDL_image's decoders are loaded, on the worker.
+    int queued;
+    int finished;
+
+    std::thread worker;
+    std::mutex job_lock;
+    std::condition_variable job_ready;  // A job was queued, or stopping.
+    std::condition_variable job_done;
+    std::mutex font_lock;
+    bool stopping;  // Guarded by job_lock.
+};
+
+#endif  // SRC_ASSET_CACHE_H_
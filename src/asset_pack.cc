@@ -0,0 +1,103 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/asset_pack.h"
+
+#include <SDL2/SDL_image.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    bool path_less(const AssetPack::Entry& entry, const std::string& path) {
+        return std::strncmp(entry.path, path.c_str(),
+                AssetPack::PATH_SIZE) < 0;
+    }
+}
+
+bool AssetPack::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        length = static_cast<size_t>(info.st_size);
+        base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED)
+            base = nullptr;
+    }
+    ::close(fd);
+    if (base == nullptr) {
+        std::cerr << "cannot map asset pack " << path << std::endl;
+        return false;
+    }
+
+    // Check the index before trusting any offset in it.
+    header = static_cast<const Header*>(base);
+    index = reinterpret_cast<const Entry*>(header + 1);
+    bool ok = length >= sizeof(Header) && header->magic == MAGIC &&
+        header->version == VERSION &&
+        header->count <= (length - sizeof(Header)) / sizeof(Entry);
+    for (uint32_t i = 0; ok && i < header->count; i++) {
+        const Entry& entry = index[i];
+        ok = entry.path[PATH_SIZE - 1] == '\0' &&
+            entry.offset <= length && entry.size <= length - entry.offset &&
+            (entry.format == RAW || (entry.format == ARGB8888 &&
+                entry.pitch >= 4*static_cast<uint64_t>(entry.width) &&
+                static_cast<uint64_t>(entry.pitch)*entry.height <= entry.size));
+    }
+    if (!ok) {
+        std::cerr << path << " is not a valid asset pack" << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close() {
+    if (base != nullptr)
+        munmap(base, length);
+    base = nullptr;
+    length = 0;
+    header = nullptr;
+    index = nullptr;
+}
+
+const AssetPack::Entry* AssetPack::find(const std::string& path) const {
+    if (base == nullptr)
+        return nullptr;
+    const Entry* end = index + header->count;
+    const Entry* entry = std::lower_bound(index, end, path, path_less);
+    if (entry == end || path != entry->path)
+        return nullptr;
+    return entry;
+}
+
+SDL_RWops* AssetPack::open_rw(const std::string& path) const {
+    const Entry* entry = find(path);
+    if (entry == nullptr || entry->format != RAW)
+        return nullptr;
+    return SDL_RWFromConstMem(data(*entry), static_cast<int>(entry->size));
+}
+
+SDL_Surface* AssetPack::load_surface(const std::string& path) const {
+    const Entry* entry = find(path);
+    if (entry == nullptr)
+        return nullptr;
+    if (entry->format == RAW)
+        return IMG_Load_RW(
+                SDL_RWFromConstMem(data(*entry), static_cast<int>(entry->size)),
+                1);
+
+    // SDL only reads from the pixels of surfaces it doesn't own, which
+    // is all a texture upload or a blit from it does.
+    return SDL_CreateRGBSurfaceWithFormatFrom(
+            const_cast<void*>(data(*entry)), entry->width, entry->height,
+            32, entry->pitch, SDL_PIXELFORMAT_ARGB8888);
+}
@@ -0,0 +1,86 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_ASSET_PACK_H_
+#define SRC_ASSET_PACK_H_
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+// Read-only view of a pack file written by tools/pack_assets: the files
+// under resources/ concatenated behind an index, mapped into memory in one
+// go. Files are looked up by the path the game would otherwise open, e.g.
+// "resources/fonts/bitwise.ttf", and served straight from the mapping.
+//
+// Layout, little-endian:
+//   Header
+//   Entry[header.count], sorted by path
+//   data, each entry's bytes at its offset (from the start of the file),
+//   aligned to ALIGNMENT
+class AssetPack {
+ public:
+    static const uint32_t MAGIC = 0x4b415054;  // "TPAK".
+    static const uint32_t VERSION = 1;
+    static const int PATH_SIZE = 112;
+    static const int ALIGNMENT = 16;
+
+    enum Format {
+        RAW,      // The file as it is on disk.
+        ARGB8888  // An image decoded to width x height pixels, pitch
+                  // bytes per row, ready for SDL_CreateTextureFromSurface.
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;  // Number of entries.
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        char path[PATH_SIZE];  // Null-terminated.
+        uint64_t offset;
+        uint64_t size;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t pitch;
+    };
+
+    AssetPack() : base(nullptr), length(0), header(nullptr), index(nullptr) { }
+    ~AssetPack() { close(); }
+
+    // Maps path. Returns false if it cannot be opened, and reports on
+    // stderr if it is not a valid pack.
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return base != nullptr; }
+
+    // Entry of path, null if the pack doesn't have it.
+    const Entry* find(const std::string& path) const;
+    const void* data(const Entry& entry) const {
+        return static_cast<const char*>(base) + entry.offset;
+    }
+
+    // Read-only stream over a RAW entry, or null. Closing it leaves the
+    // mapping alone.
+    SDL_RWops* open_rw(const std::string& path) const;
+
+    // Image of path, or null. ARGB8888 entries are wrapped without copying
+    // or decoding (the surface must not outlive the pack), RAW ones are
+    // decoded with SDL_image. Free with SDL_FreeSurface.
+    SDL_Surface* load_surface(const std::string& path) const;
+
+ private:
+    AssetPack(const AssetPack&);
+    AssetPack& operator=(const AssetPack&);
+
+    void* base;
+    size_t length;
+    const Header* header;
+    const Entry* index;
+};
+
+#endif  // SRC_ASSET_PACK_H_
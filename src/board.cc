@@ -2,14 +2,65 @@
 
 #include "src/tetromino.h"
 #include "src/board.h"
+#include "src/hash.h"
+
+namespace {
+    // Random keys for Zobrist hashing, generated once.
+    struct ZobristKeys {
+        uint64_t block[Board::COLS][7];  // Block of a color in a column.
+        uint64_t row[Board::ROWS];  // Position of a row on the board.
+
+        ZobristKeys() {
+            uint64_t seed = 0;
+            for (int j = 0; j < Board::COLS; j++)
+                for (int k = 0; k < 7; k++)
+                    block[j][k] = hash_mix(seed++);
+            for (int i = 0; i < Board::ROWS; i++)
+                row[i] = hash_mix(seed++);
+        }
+    };
+
+    const ZobristKeys& keys() {
+        static const ZobristKeys k;
+        return k;
+    }
+
+    uint64_t block_key(int col, int color) {
+        return color == -1 ? 0 : keys().block[col][color];
+    }
+
+    // Contribution of a row with the given contents to the board hash.
+    uint64_t placed_row(uint64_t row_hash, int row) {
+        return hash_mix(row_hash ^ keys().row[row]);
+    }
+}
 
 Board::Board() {
     score = 0;
-    render_score = true;
+    cleared_count = 0;
     for (int i = 0; i < ROWS; i++)
         for (int j = 0; j < COLS; j++)
            // All blocks on the board are initially colorless.
             color[i][j] = -1;
+    rehash();
+}
+
+void Board::rehash() {
+    board_hash = 0;
+    for (int i = 0; i < ROWS; i++) {
+        row_hash[i] = 0;
+        for (int j = 0; j < COLS; j++)
+            row_hash[i] ^= block_key(j, color[i][j]);
+        board_hash ^= placed_row(row_hash[i], i);
+    }
+}
+
+void Board::set_color(int row, int col, int new_color) {
+    uint64_t old_row_hash = row_hash[row];
+    row_hash[row] ^= block_key(col, color[row][col]) ^ block_key(col, new_color);
+    board_hash ^= placed_row(old_row_hash, row) ^
+        placed_row(row_hash[row], row);
+    color[row][col] = new_color;
 }
 
 bool Board::full_row(int row) {
@@ -20,52 +71,77 @@ bool Board::full_row(int row) {
 }
 
 void Board::shift_down(int i) {
-    for (int row = i; row > 0; row--)
+    for (int row = i; row > 0; row--) {
         for (int col = 0; col < COLS; col++)
             color[row][col] = color[row-1][col];
+        row_hash[row] = row_hash[row-1];
+    }
 }
 
 void Board::delete_full_rows() {
     int bonus_counter = 0;  // Counts the number of consecutive row deletes.
+    cleared_count = 0;
 
     // Test every row, starting from bottom row
     for (int row = ROWS-1; row >= 0; row--) {
         if (!full_row(row))
             continue;
 
+        // Rows above moved down once per row deleted so far.
+        if (cleared_count < MAX_CLEARED) {
+            ClearedRow& event = cleared[cleared_count++];
+            event.row = row - bonus_counter;
+            for (int col = 0; col < COLS; col++)
+                event.color[col] = color[row][col];
+        }
+
         // To delete a row, shift the upper part of the board down.
         shift_down(row);
         row++;
 
-        increase_score_by(40);
         bonus_counter++;
-        render_score = true;
     }
-    switch (bonus_counter){
+    increase_score_by(line_clear_score(bonus_counter));
+
+    // Rows moved, recombine the row hashes at their new positions.
+    if (bonus_counter > 0) {
+        board_hash = 0;
+        for (int row = 0; row < ROWS; row++)
+            board_hash ^= placed_row(row_hash[row], row);
+    }
+}
+
+int Board::line_clear_score(int rows) {
+    int points = 40*rows;
+    switch (rows) {
         case 2:
-            increase_score_by(100);
+            points += 100;
             break;
         case 3:
-            increase_score_by(300);
+            points += 300;
             break;
         case 4:
-            increase_score_by(1200);
+            points += 1200;
             break;
-    }   
+    }
+    return points;
 }
 
 bool Board::add(Tetromino *tetro) {
-    for (int i = 0; i < tetro->SIZE; i++) {
-        int x = tetro->get_block_x(i);
-        int y = tetro->get_block_y(i);
+    return add(tetro->type, tetro->coords, tetro->x, tetro->y);
+}
+
+bool Board::add(int type, const int coords[][2], int x, int y) {
+    for (int i = 0; i < Tetromino::SIZE; i++) {
+        int block_x = x + coords[i][0];
+        int block_y = y + coords[i][1];
 
         // Tetromino isn't added to the board if it touches the upper border.
-        if (y <= 0)
+        if (block_y <= 0)
             return false;
         else
             // Add tetromino: update color in corresponding board block.
-            color[y][x] = tetro->type;
+            set_color(block_y, block_x, type);
     }
     return true;
 }
-
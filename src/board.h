@@ -3,6 +3,10 @@
 #ifndef SRC_BOARD_H_
 #define SRC_BOARD_H_
 
+#include <stdint.h>
+
+class Tetromino;
+
 class Board {
  public:
     static const int HEIGHT = 600;
@@ -13,18 +17,47 @@ class Board {
     static const int BLOCK_WIDTH = WIDTH / COLS;
     static const int BONUS = 3;
     int color[ROWS][COLS];
-    bool render_score;
+
+    // Rows removed by the last delete_full_rows() call, bottom first, with
+    // their index and blocks as they were before removal. Used for
+    // effects. A piece spans at most 4 rows, so at most 4 can be full.
+    static const int MAX_CLEARED = 4;
+    struct ClearedRow {
+        int row;
+        int color[COLS];
+    };
+    ClearedRow cleared[MAX_CLEARED];
+    int cleared_count;
 
     Board();
     void increase_score_by(int delta) {score += delta;}
     int get_score() {return score;}
     void delete_full_rows();
     bool add(Tetromino* tetro);
+    // Same as add(), for a tetromino of the given type whose blocks are at
+    // (x, y) + coords[i].
+    bool add(int type, const int coords[][2], int x, int y);
+
+    // Zobrist hash of the locked blocks, kept up to date by add() and
+    // delete_full_rows().
+    uint64_t hash() const {return board_hash;}
+    // Recomputes the hash after color was written to directly.
+    void rehash();
+
+    // Points awarded for clearing the given number of rows at once.
+    static int line_clear_score(int rows);
 
  private:
     bool full_row(int row);
     void shift_down(int row);
+    void set_color(int row, int col, int new_color);
     int score;
+
+    // Hash of each row's contents regardless of its position. The board
+    // hash combines them with the row index, so clearing rows only has to
+    // recombine ROWS values instead of rehashing every block.
+    uint64_t row_hash[ROWS];
+    uint64_t board_hash;
 };
 
 #endif  // SRC_BOARD_H_
@@ -0,0 +1,191 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/board_batch.h"
+
+#include <algorithm>
+#include <cstring>
+
+BoardBatch::BoardBatch(int size)
+    : type(size), next_type(size), rotation(size), x(size), y(size),
+      score(size), lines(size), pieces(size), game_over(size),
+      count(size),
+      rows(size*STRIDE), colors(size*ROWS*COLS), rng(size), landed(size) {
+    reset_all(1);
+}
+
+namespace {
+    // Built once, on first use (thread-safe static initialization).
+    struct MaskTable {
+        BoardBatch::Row masks[7][4][5];
+
+        MaskTable() {
+            std::memset(masks, 0, sizeof(masks));
+            for (int t = 0; t < 7; t++)
+                for (int r = 0; r < 4; r++) {
+                    int coords[4][2];
+                    Tetromino::rotated_coords(t, r, coords);
+                    for (int i = 0; i < Tetromino::SIZE; i++)
+                        masks[t][r][coords[i][1] + 2] |=
+                            1u << (coords[i][0] + 2);
+                }
+        }
+    };
+}
+
+const BoardBatch::PieceMasks& BoardBatch::masks() {
+    static const MaskTable table;
+    return table.masks;
+}
+
+void BoardBatch::reset(int game, uint32_t seed) {
+    Row* r = &rows[game*STRIDE];
+    for (int i = 0; i < PAD_TOP + ROWS; i++)
+        r[i] = EMPTY_ROW;
+    for (int i = PAD_TOP + ROWS; i < STRIDE; i++)
+        r[i] = SOLID_ROW;
+    std::fill(colors.begin() + game*ROWS*COLS,
+            colors.begin() + (game+1)*ROWS*COLS, -1);
+
+    // xorshift32 gets stuck on a zero state.
+    rng[game] = seed ? seed : 0x9e3779b9u;
+
+    score[game] = 0;
+    lines[game] = 0;
+    pieces[game] = 0;
+    game_over[game] = 0;
+
+    next_type[game] = random_type(game);
+    spawn(game);
+}
+
+void BoardBatch::reset_all(uint32_t seed) {
+    for (int g = 0; g < count; g++)
+        reset(g, seed + 0x9e3779b9u*static_cast<uint32_t>(g));
+}
+
+int BoardBatch::random_type(int game) {
+    uint32_t s = rng[game];
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    rng[game] = s;
+    return s % 7;
+}
+
+void BoardBatch::spawn(int game) {
+    type[game] = next_type[game];
+    next_type[game] = random_type(game);
+    rotation[game] = 0;
+    x[game] = COLS/2;
+    y[game] = 0;
+}
+
+int BoardBatch::tick() {
+    // Gravity for all games at once. No branches on game state here so
+    // the loop stays a straight pass over the piece arrays.
+    for (int g = 0; g < count; g++) {
+        int blocked = collides(g, type[g], rotation[g], x[g], y[g] + 1);
+        int active = !game_over[g];
+        landed[g] = blocked & active;
+        y[g] += (!blocked) & active;
+    }
+
+    // Locking is rare compared to falling, handle it per game.
+    int locked = 0;
+    for (int g = 0; g < count; g++)
+        if (landed[g]) {
+            lock(g);
+            locked++;
+        }
+    return locked;
+}
+
+bool BoardBatch::shift(int game, int dx) {
+    if (game_over[game] ||
+            collides(game, type[game], rotation[game], x[game] + dx, y[game]))
+        return false;
+    x[game] += dx;
+    return true;
+}
+
+bool BoardBatch::rotate(int game, int drot) {
+    int rot = (rotation[game] + drot) & 3;
+    if (game_over[game] || collides(game, type[game], rot, x[game], y[game]))
+        return false;
+    rotation[game] = rot;
+    return true;
+}
+
+void BoardBatch::hard_drop(int game) {
+    if (game_over[game])
+        return;
+    while (!collides(game, type[game], rotation[game], x[game], y[game] + 1))
+        y[game]++;
+    lock(game);
+}
+
+void BoardBatch::lock(int game) {
+    int coords[4][2];
+    Tetromino::rotated_coords(type[game], rotation[game], coords);
+
+    int top = ROWS, bottom = -1;
+    for (int i = 0; i < Tetromino::SIZE; i++) {
+        int bx = x[game] + coords[i][0];
+        int by = y[game] + coords[i][1];
+
+        // Same rule as Board::add: touching the upper border ends the game.
+        if (by <= 0) {
+            game_over[game] = 1;
+            return;
+        }
+        rows[game*STRIDE + PAD_TOP + by] |= 1u << (bx + WALL_BITS);
+        colors[(game*ROWS + by)*COLS + bx] = type[game];
+        top = std::min(top, by);
+        bottom = std::max(bottom, by);
+    }
+    pieces[game]++;
+
+    int cleared = clear_rows(game, top, bottom);
+    if (cleared) {
+        lines[game] += cleared;
+        score[game] += Board::line_clear_score(cleared);
+    }
+    spawn(game);
+}
+
+int BoardBatch::clear_rows(int game, int top, int bottom) {
+    Row* r = &rows[game*STRIDE + PAD_TOP];
+    int8_t* c = &colors[game*ROWS*COLS];
+
+    // Only the rows touched by the piece that just locked can be full.
+    bool any_full = false;
+    for (int row = top; row <= bottom; row++)
+        any_full |= r[row] == SOLID_ROW;
+    if (!any_full)
+        return 0;
+
+    // Compact the rows above the piece downwards, skipping full ones.
+    int dst = bottom;
+    for (int src = bottom; src >= 0; src--) {
+        if (r[src] == SOLID_ROW)
+            continue;
+        if (dst != src) {
+            r[dst] = r[src];
+            std::memcpy(c + dst*COLS, c + src*COLS, COLS);
+        }
+        dst--;
+    }
+    int cleared = dst + 1;
+    for (int row = 0; row <= dst; row++) {
+        r[row] = EMPTY_ROW;
+        std::memset(c + row*COLS, -1, COLS);
+    }
+    return cleared;
+}
+
+void BoardBatch::copy_to(int game, Board* board) const {
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLS; j++)
+            board->color[i][j] = color(game, i, j);
+    board->rehash();
+}
@@ -0,0 +1,117 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_BOARD_BATCH_H_
+#define SRC_BOARD_BATCH_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "src/tetromino.h"
+#include "src/board.h"
+
+// Steps many independent games in lockstep.
+//
+// Boards are stored as one contiguous array of row bitmasks and pieces as
+// parallel arrays (structure of arrays), so gravity, collision and line
+// clears are flat loops over games instead of one Board/Tetromino pair per
+// game. Game rules match PlayState: pieces spawn at (COLS/2, 0), a piece
+// that locks with a block at y <= 0 ends the game (see Board::add) and line
+// clears are scored by Board::line_clear_score.
+class BoardBatch {
+ public:
+    typedef uint32_t Row;
+
+    static const int ROWS = Board::ROWS;
+    static const int COLS = Board::COLS;
+
+    // Each row keeps 4 wall bits on both sides of the COLS cell bits, and
+    // the board is padded with empty rows above and solid rows below, so a
+    // collision test is a handful of ANDs with no bounds checks.
+    static const int WALL_BITS = 4;
+    static const int PAD_TOP = 4;
+    static const int PAD_BOTTOM = 4;
+    static const int STRIDE = PAD_TOP + ROWS + PAD_BOTTOM;
+    static const Row SOLID_ROW = (1u << (COLS + 2*WALL_BITS)) - 1;
+    static const Row EMPTY_ROW = SOLID_ROW & ~(((1u << COLS) - 1) << WALL_BITS);
+
+    explicit BoardBatch(int size);
+
+    int size() const { return count; }
+
+    // Empties one board and deals it a new piece sequence from seed.
+    void reset(int game, uint32_t seed);
+    // Resets every game, each with its own seed derived from seed.
+    void reset_all(uint32_t seed);
+
+    // Moves every active piece down one row. Pieces that cannot fall are
+    // locked, full rows are cleared and the next piece is spawned.
+    // Returns the number of pieces locked during this tick.
+    int tick();
+
+    // Player-style moves on a single game. Return false (and leave the
+    // piece untouched) if the move collides.
+    bool shift(int game, int dx);
+    bool rotate(int game, int drot);
+    // Drops the piece of one game to the bottom and locks it.
+    void hard_drop(int game);
+
+    // True if a piece of the given type and rotation collides with the
+    // walls, the floor or locked blocks of a game at (x, y).
+    bool collides(int game, int piece_type, int rot, int x, int y) const {
+        const Row* r = &rows[game*STRIDE + PAD_TOP + y - 2];
+        const Row* m = masks()[piece_type][rot & 3];
+        int s = x + 2;
+        return ((r[0] & (m[0] << s)) | (r[1] & (m[1] << s)) |
+                (r[2] & (m[2] << s)) | (r[3] & (m[3] << s)) |
+                (r[4] & (m[4] << s))) != 0;
+    }
+
+    // Cell bits of a board row, bit c set if column c is occupied.
+    Row cells(int game, int row) const {
+        return (rows[game*STRIDE + PAD_TOP + row] >> WALL_BITS) &
+            ((1u << COLS) - 1);
+    }
+
+    // Color of a locked block (tetromino type), -1 if empty. Same
+    // convention as Board::color.
+    int color(int game, int row, int col) const {
+        return colors[(game*ROWS + row)*COLS + col];
+    }
+
+    // Writes the locked blocks of a game into a Board.
+    void copy_to(int game, Board* board) const;
+
+    // Piece state, one entry per game.
+    std::vector<int8_t> type;
+    std::vector<int8_t> next_type;
+    std::vector<int8_t> rotation;  // Number of right rotations.
+    std::vector<int8_t> x;
+    std::vector<int8_t> y;
+
+    // Game statistics, one entry per game.
+    std::vector<int32_t> score;
+    std::vector<int32_t> lines;
+    std::vector<int32_t> pieces;
+    std::vector<uint8_t> game_over;
+
+ private:
+    // Per type and rotation, bit (dx+2) of masks[t][r][dy+2] is set for
+    // every block (dx, dy) of the rotated tetromino.
+    typedef Row PieceMasks[7][4][5];
+    static const PieceMasks& masks();
+
+    void lock(int game);
+    int clear_rows(int game, int top, int bottom);
+    void spawn(int game);
+    int random_type(int game);
+
+    int count;
+
+    std::vector<Row> rows;  // count*STRIDE row bitmasks.
+    std::vector<int8_t> colors;  // count*ROWS*COLS block colors.
+    std::vector<uint32_t> rng;  // Per-game xorshift state.
+    std::vector<uint8_t> landed;  // Scratch array used by tick().
+};
+
+#endif  // SRC_BOARD_BATCH_H_
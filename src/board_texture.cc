@@ -0,0 +1,90 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/board_texture.h"
+
+#include "src/tetromino.h"
+#include "src/board.h"
+#include "src/board_batch.h"
+#include "src/profiler.h"
+
+// ARGB colors: empty, then Z, J, O, T, S, I and L blocks.
+const Uint32 BoardTexture::PALETTE[8] = {
+    0xff000000, 0xffe03030, 0xff3050e0, 0xffe0e030, 0xffa030e0,
+    0xff30e050, 0xff30d0e0, 0xffe09030
+};
+
+bool BoardTexture::create(SDL_Renderer* renderer) {
+    destroy();
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STREAMING, Board::COLS, Board::ROWS);
+    if (texture == nullptr)
+        return false;
+    SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+    return true;
+}
+
+void BoardTexture::destroy() {
+    if (texture != nullptr) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+}
+
+void BoardTexture::update(const Board& board, const Tetromino* active) {
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) != 0)
+        return;
+
+    for (int i = 0; i < Board::ROWS; i++) {
+        Uint32* row = reinterpret_cast<Uint32*>(
+                static_cast<Uint8*>(pixels) + i*pitch);
+        for (int j = 0; j < Board::COLS; j++)
+            row[j] = PALETTE[board.color[i][j] + 1];
+    }
+
+    if (active != nullptr)
+        for (int k = 0; k < Tetromino::SIZE; k++) {
+            int x = active->x + active->coords[k][0];
+            int y = active->y + active->coords[k][1];
+            if (x >= 0 && x < Board::COLS && y >= 0 && y < Board::ROWS)
+                reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) +
+                        y*pitch)[x] = PALETTE[active->type + 1];
+        }
+
+    SDL_UnlockTexture(texture);
+}
+
+void BoardTexture::update(const BoardBatch& batch, int game) {
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) != 0)
+        return;
+
+    for (int i = 0; i < Board::ROWS; i++) {
+        Uint32* row = reinterpret_cast<Uint32*>(
+                static_cast<Uint8*>(pixels) + i*pitch);
+        for (int j = 0; j < Board::COLS; j++)
+            row[j] = PALETTE[batch.color(game, i, j) + 1];
+    }
+
+    if (!batch.game_over[game]) {
+        int coords[4][2];
+        Tetromino::rotated_coords(batch.type[game], batch.rotation[game],
+                coords);
+        for (int k = 0; k < Tetromino::SIZE; k++) {
+            int x = batch.x[game] + coords[k][0];
+            int y = batch.y[game] + coords[k][1];
+            if (y >= 0 && y < Board::ROWS)
+                reinterpret_cast<Uint32*>(static_cast<Uint8*>(pixels) +
+                        y*pitch)[x] = PALETTE[batch.type[game] + 1];
+        }
+    }
+
+    SDL_UnlockTexture(texture);
+}
+
+void BoardTexture::draw(SDL_Renderer* renderer, const SDL_Rect& dst) const {
+    SDL_RenderCopy(renderer, texture, nullptr, &dst);
+    FrameProfiler::count_draw_calls();
+}
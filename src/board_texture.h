@@ -0,0 +1,43 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_BOARD_TEXTURE_H_
+#define SRC_BOARD_TEXTURE_H_
+
+#include <SDL2/SDL.h>
+
+class Board;
+class BoardBatch;
+class Tetromino;
+
+// Renders a whole board as one tiny streaming texture, one texel per cell,
+// upscaled with nearest filtering when drawn. Cell colors come from a
+// palette indexed like Board::color. Meant for showing many boards at
+// once: each board costs one small texture update and one copy instead of
+// a sprite per block.
+class BoardTexture {
+ public:
+    // Palette entry of empty cells, then of each tetromino type.
+    static const Uint32 PALETTE[8];
+
+    BoardTexture() : texture(nullptr) { }
+    ~BoardTexture() { destroy(); }
+
+    bool create(SDL_Renderer* renderer);
+    void destroy();
+
+    // Uploads the locked blocks of a board and, if given, its falling
+    // tetromino.
+    void update(const Board& board, const Tetromino* active = nullptr);
+    // Same for one game of a batch, including its current piece.
+    void update(const BoardBatch& batch, int game);
+
+    void draw(SDL_Renderer* renderer, const SDL_Rect& dst) const;
+
+ private:
+    BoardTexture(const BoardTexture&);
+    BoardTexture& operator=(const BoardTexture&);
+
+    SDL_Texture* texture;
+};
+
+#endif  // SRC_BOARD_TEXTURE_H_
@@ -0,0 +1,68 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/bot.h"
+
+#include "src/board_batch.h"
+#include "src/movegen.h"
+
+const BotWeights BOTS[NUM_BOTS] = {
+    { "balanced",  -0.51, -0.36, -0.18, 0.02 },
+    { "flat",      -0.30, -0.50, -0.45, 0.01 },
+    { "greedy",    -0.20, -0.25, -0.10, 0.08 },
+    { "stacker",   -0.05, -0.60, -0.20, 0.03 },
+};
+
+namespace {
+    double evaluate(const Board& board, const BotWeights& weights,
+            int points) {
+        int heights[Board::COLS];
+        int holes = 0;
+        for (int j = 0; j < Board::COLS; j++) {
+            int i = 0;
+            while (i < Board::ROWS && board.color[i][j] == -1)
+                i++;
+            heights[j] = Board::ROWS - i;
+            for (; i < Board::ROWS; i++)
+                holes += board.color[i][j] == -1;
+        }
+
+        int aggregate = 0, bumpiness = 0;
+        for (int j = 0; j < Board::COLS; j++) {
+            aggregate += heights[j];
+            if (j > 0)
+                bumpiness += heights[j] > heights[j-1] ?
+                    heights[j] - heights[j-1] : heights[j-1] - heights[j];
+        }
+
+        return weights.height*aggregate + weights.holes*holes +
+            weights.bumpiness*bumpiness + weights.points*points;
+    }
+}
+
+int choose_action(const BoardBatch& batch, int game,
+        const BotWeights& weights, Board* scratch) {
+    int type = batch.type[game];
+    batch.copy_to(game, scratch);
+
+    Placement placements[MAX_PLACEMENTS];
+    int n = generate_placements(*scratch, type, placements);
+
+    int best = -1;
+    double best_value = 0;
+    for (int i = 0; i < n; i++) {
+        Board child = *scratch;
+        int before = child.get_score();
+        if (!apply_placement(&child, type, placements[i]))
+            continue;
+        double value = evaluate(child, weights, child.get_score() - before);
+        if (best == -1 || value > best_value) {
+            best = i;
+            best_value = value;
+        }
+    }
+
+    // Nothing fits without topping out: any action ends the game.
+    if (best == -1)
+        return 0;
+    return placements[best].rot*Board::COLS + placements[best].x;
+}
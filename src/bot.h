@@ -0,0 +1,29 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_BOT_H_
+#define SRC_BOT_H_
+
+#include "src/board.h"
+
+class BoardBatch;
+
+// A simple placement bot: tries every placement from generate_placements()
+// and keeps the one with the best weighted score of the resulting board.
+struct BotWeights {
+    const char* name;
+    double height;     // Per block of aggregate column height.
+    double holes;      // Per empty block below a filled one.
+    double bumpiness;  // Per block of height difference between columns.
+    double points;     // Per point scored by the placement.
+};
+
+// Contestants of AI tournaments.
+const int NUM_BOTS = 4;
+extern const BotWeights BOTS[NUM_BOTS];
+
+// Chooses the placement of the current piece of one game of a batch,
+// returned as a TetrisEnv action. scratch is used as work space.
+int choose_action(const BoardBatch& batch, int game,
+        const BotWeights& weights, Board* scratch);
+
+#endif  // SRC_BOT_H_
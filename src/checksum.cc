@@ -0,0 +1,46 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/checksum.h"
+
+#include <cinttypes>
+
+bool ChecksumLog::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "w");
+    return file != nullptr;
+}
+
+void ChecksumLog::close() {
+    if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void ChecksumLog::record(const TickChecksum& checksum) {
+    if (file == nullptr)
+        return;
+    std::fprintf(file,
+            "%" PRIu32 " %016" PRIx64 " %016" PRIx64 " %" PRId32 "\n",
+            checksum.tick, checksum.board, checksum.piece, checksum.score);
+}
+
+bool read_checksums(const std::string& path,
+        std::vector<TickChecksum>* checksums) {
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (file == nullptr)
+        return false;
+
+    bool ok = true;
+    TickChecksum c;
+    int fields;
+    while ((fields = std::fscanf(file,
+                    "%" SCNu32 " %" SCNx64 " %" SCNx64 " %" SCNd32,
+                    &c.tick, &c.board, &c.piece, &c.score)) == 4)
+        checksums->push_back(c);
+    if (fields != EOF)
+        ok = false;
+
+    std::fclose(file);
+    return ok;
+}
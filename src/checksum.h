@@ -0,0 +1,54 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_CHECKSUM_H_
+#define SRC_CHECKSUM_H_
+
+#include <stdint.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// State of the game after one simulation tick. Two runs (or two builds)
+// behave the same as long as their checksum streams are identical.
+struct TickChecksum {
+    uint32_t tick;
+    uint64_t board;  // Board::hash().
+    uint64_t piece;  // Tetromino::hash() of the falling tetromino.
+    int32_t score;
+
+    bool operator==(const TickChecksum& other) const {
+        return tick == other.tick && board == other.board &&
+            piece == other.piece && score == other.score;
+    }
+    bool operator!=(const TickChecksum& other) const {
+        return !(*this == other);
+    }
+};
+
+// Writes a checksum stream, one text line per tick:
+// "<tick> <board hash> <piece hash> <score>", hashes in hexadecimal.
+class ChecksumLog {
+ public:
+    ChecksumLog() : file(nullptr) { }
+    ~ChecksumLog() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const { return file != nullptr; }
+
+    void record(const TickChecksum& checksum);
+
+ private:
+    ChecksumLog(const ChecksumLog&);
+    ChecksumLog& operator=(const ChecksumLog&);
+
+    FILE* file;
+};
+
+// Reads a stream written by ChecksumLog. Returns false if the file cannot
+// be opened or a line is malformed.
+bool read_checksums(const std::string& path,
+        std::vector<TickChecksum>* checksums);
+
+#endif  // SRC_CHECKSUM_H_
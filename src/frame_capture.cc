@@ -0,0 +1,184 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/frame_capture.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <cctype>
+#include <iostream>
+
+FrameCapture::FrameCapture()
+    : running(false), stopping(false), width(0), height(0), png(false),
+      raw(nullptr), frames_captured(0), frames_dropped(0) { }
+
+bool FrameCapture::start(const std::string& new_output,
+        int new_width, int new_height) {
+    stop();
+
+    output = new_output;
+    width = new_width;
+    height = new_height;
+    png = output.size() >= 4 &&
+        output.compare(output.size() - 4, 4, ".png") == 0;
+    std::string path;
+    if (png && !frame_path(output, 0, &path)) {
+        std::cerr << "frame pattern " << output
+            << " needs exactly one %d" << std::endl;
+        return false;
+    }
+    if (!png) {
+        raw = std::fopen(output.c_str(), "wb");
+        if (raw == nullptr) {
+            std::cerr << "cannot write frames to " << output << std::endl;
+            return false;
+        }
+    }
+
+    // All memory is allocated here, capturing only recycles it.
+    free_buffers.clear();
+    free_buffers.reserve(POOL_SIZE);
+    queue.clear();
+    queue.reserve(POOL_SIZE);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        pool[i].pixels.resize(width*height);
+        free_buffers.push_back(&pool[i]);
+    }
+
+    frames_captured = 0;
+    frames_dropped = 0;
+    stopping = false;
+    running = true;
+    encoder = std::thread(&FrameCapture::encode, this);
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (!running)
+        return;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    queued.notify_one();
+    encoder.join();
+    running = false;
+
+    if (raw != nullptr)
+        std::fclose(raw);
+    raw = nullptr;
+}
+
+void FrameCapture::capture(SDL_Renderer* renderer) {
+    if (!running)
+        return;
+
+    Buffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!free_buffers.empty()) {
+            buffer = free_buffers.back();
+            free_buffers.pop_back();
+        }
+    }
+    int index = frames_captured + frames_dropped;
+    if (buffer == nullptr) {
+        frames_dropped++;
+        return;
+    }
+
+    // The read back itself has to happen here, on the rendering thread;
+    // encoding and disk writes are left to the encoder.
+    buffer->index = index;
+    if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_RGBA32,
+                &buffer->pixels[0], width*4) != 0) {
+        std::lock_guard<std::mutex> guard(lock);
+        free_buffers.push_back(buffer);
+        frames_dropped++;
+        return;
+    }
+    frames_captured++;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.push_back(buffer);
+    }
+    queued.notify_one();
+}
+
+// Encoder thread.
+void FrameCapture::encode() {
+    bool ok = true;
+    while (true) {
+        Buffer* buffer;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            while (queue.empty() && !stopping)
+                queued.wait(guard);
+            if (queue.empty())
+                return;
+            buffer = queue.front();
+            queue.erase(queue.begin());
+        }
+
+        // Keep draining after an error so the game never runs out of
+        // buffers, but report it once.
+        if (ok && !write(*buffer)) {
+            std::cerr << "cannot write frame " << buffer->index << " to "
+                << output << std::endl;
+            ok = false;
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        free_buffers.push_back(buffer);
+    }
+}
+
+bool FrameCapture::write(const Buffer& buffer) {
+    if (!png)
+        return std::fwrite(&buffer.pixels[0], 4, buffer.pixels.size(), raw)
+            == buffer.pixels.size();
+
+    std::string path;
+    frame_path(output, buffer.index, &path);
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+            const_cast<uint32_t*>(&buffer.pixels[0]), width, height, 32,
+            width*4, SDL_PIXELFORMAT_RGBA32);
+    bool ok = surface != nullptr && IMG_SavePNG(surface, path.c_str()) == 0;
+    if (surface != nullptr)
+        SDL_FreeSurface(surface);
+    return ok;
+}
+
+bool FrameCapture::frame_path(const std::string& pattern, int index,
+        std::string* path) {
+    path->clear();
+    int conversions = 0;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] != '%') {
+            path->push_back(pattern[i]);
+            continue;
+        }
+        if (++i < pattern.size() && pattern[i] == '%') {
+            path->push_back('%');
+            continue;
+        }
+
+        bool zero = i < pattern.size() && pattern[i] == '0';
+        if (zero)
+            i++;
+        int width = 0;
+        while (i < pattern.size() && std::isdigit(pattern[i])) {
+            width = width*10 + (pattern[i++] - '0');
+            if (width > 64)
+                return false;
+        }
+        if (i == pattern.size() || pattern[i] != 'd' || ++conversions > 1)
+            return false;
+
+        char number[80];
+        std::snprintf(number, sizeof(number), zero ? "%0*d" : "%*d",
+                width, index);
+        path->append(number);
+    }
+    return conversions == 1;
+}
@@ -0,0 +1,83 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_FRAME_CAPTURE_H_
+#define SRC_FRAME_CAPTURE_H_
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records rendered frames without slowing the game down. Frames are read
+// back into a small pool of reusable buffers and handed to an encoder
+// thread, which writes them as PNG images or appends them to a raw RGBA
+// stream. When the encoder falls behind and no buffer is free, frames are
+// dropped instead of making the game wait.
+class FrameCapture {
+ public:
+    static const int POOL_SIZE = 4;
+
+    FrameCapture();
+    ~FrameCapture() { stop(); }
+
+    // If output ends in ".png" it is a pattern for one image per frame
+    // (e.g. frames/%06d.png, see frame_path()), otherwise raw frames are
+    // appended to it. Returns false if the output cannot be opened or the
+    // pattern is invalid.
+    bool start(const std::string& output, int width, int height);
+    // Writes the frames still queued and stops the encoder.
+    void stop();
+    bool active() const { return running; }
+
+    // Reads back the current render target, before it is presented.
+    void capture(SDL_Renderer* renderer);
+
+    int captured() const { return frames_captured; }
+    int dropped() const { return frames_dropped; }
+
+    // Path of frame index: pattern with its one %d, %Nd or %0Nd replaced
+    // by the number and %% by %. Returns false if the pattern has no such
+    // conversion, more than one, or any other % sequence.
+    static bool frame_path(const std::string& pattern, int index,
+            std::string* path);
+
+ private:
+    FrameCapture(const FrameCapture&);
+    FrameCapture& operator=(const FrameCapture&);
+
+    struct Buffer {
+        std::vector<uint32_t> pixels;  // RGBA32.
+        int index;  // Frame number.
+    };
+
+    void encode();
+    bool write(const Buffer& buffer);
+
+    Buffer pool[POOL_SIZE];
+
+    // Both hold at most POOL_SIZE buffers, reserved up front.
+    std::vector<Buffer*> free_buffers;
+    std::vector<Buffer*> queue;  // Oldest first.
+
+    std::mutex lock;
+    std::condition_variable queued;
+    std::thread encoder;
+    bool running;
+    bool stopping;
+
+    int width;
+    int height;
+    std::string output;
+    bool png;
+    FILE* raw;
+
+    int frames_captured;
+    int frames_dropped;
+};
+
+#endif  // SRC_FRAME_CAPTURE_H_
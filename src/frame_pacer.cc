@@ -0,0 +1,45 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/frame_pacer.h"
+
+FramePacer::FramePacer()
+    : mode(Options::VSYNC), period(0), deadline(0) { }
+
+void FramePacer::init(Options::Pacing new_mode, int fps) {
+    mode = new_mode;
+    period = SDL_GetPerformanceFrequency() / (fps > 0 ? fps : 60);
+    deadline = SDL_GetPerformanceCounter() + period;
+}
+
+bool FramePacer::vsync() const {
+    return mode == Options::VSYNC || mode == Options::IDLE;
+}
+
+void FramePacer::wait_for_events(bool idle) {
+    // A null event leaves the event in the queue for the state to poll.
+    if (mode == Options::IDLE && idle)
+        SDL_WaitEventTimeout(nullptr, IDLE_TIMEOUT);
+}
+
+void FramePacer::end_frame() {
+    if (mode != Options::CAP)
+        return;
+
+    uint64_t frequency = SDL_GetPerformanceFrequency();
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (now < deadline) {
+        // Sleep through most of the remaining time...
+        uint64_t ms = (deadline - now)*1000 / frequency;
+        if (ms > SPIN_MARGIN)
+            SDL_Delay(static_cast<Uint32>(ms - SPIN_MARGIN));
+
+        // ...and spin for the rest.
+        while (SDL_GetPerformanceCounter() < deadline) { }
+        now = deadline;
+    }
+
+    // Don't rush frames to catch up after a long one.
+    deadline += period;
+    if (deadline < now)
+        deadline = now + period;
+}
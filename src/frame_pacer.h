@@ -0,0 +1,44 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_FRAME_PACER_H_
+#define SRC_FRAME_PACER_H_
+
+#include <SDL2/SDL.h>
+
+#include "src/options.h"
+
+// Decides how long the main loop waits between frames.
+//   VSYNC:    SDL_RenderPresent waits for the display.
+//   CAP:      no vsync, frames are spaced 1/fps apart: sleep for most of
+//             the remaining time, then spin for the last few milliseconds
+//             since SDL_Delay may oversleep.
+//   UNCAPPED: no waiting at all, for benchmarks.
+//   IDLE:     like VSYNC, but while the state reports nothing is changing
+//             the loop blocks until an event arrives (or IDLE_TIMEOUT).
+class FramePacer {
+ public:
+    static const int IDLE_TIMEOUT = 250;  // Milliseconds.
+
+    FramePacer();
+
+    void init(Options::Pacing mode, int fps);
+
+    // Whether the renderer should be created with vsync.
+    bool vsync() const;
+
+    // Before handling input. idle is the state's GameState::idle().
+    void wait_for_events(bool idle);
+
+    // After the frame was presented.
+    void end_frame();
+
+ private:
+    // Time left to spin after sleeping, in milliseconds.
+    static const int SPIN_MARGIN = 2;
+
+    Options::Pacing mode;
+    uint64_t period;  // Performance counter ticks per frame.
+    uint64_t deadline;  // When the current frame should end.
+};
+
+#endif  // SRC_FRAME_PACER_H_
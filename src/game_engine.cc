@@ -1,84 +1,310 @@
 // Copyright [2015] <Chafic Najjar>
 
 #include "src/game_engine.h"
+
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
 #include "src/gamestate.h"
 
-GameEngine::GameEngine() {
-    // Initialize audio, CD-ROM, event handling, file I/O,
-    // joystick handling, threading, timers and videos.
-    SDL_Init(SDL_INIT_EVERYTHING);
+GameEngine::GameEngine(const Options& options) : options(options) {
+    if (!options.startup_trace_path.empty())
+        trace.enable();
+    assets.set_trace(&trace);
+
+    // Video and events only. Nothing uses SDL's audio (irrKlang has its
+    // own), joysticks or timers, and each costs startup time; SDL_ttf,
+    // SDL_image and irrKlang start on first use, see AssetCache.
+    {
+        StartupTrace::Scope scope(&trace, "SDL_Init");
+        SDL_Init(SDL_INIT_VIDEO);
+    }
+
+    // One mapping for every asset, when the pack was built.
+    {
+        StartupTrace::Scope scope(&trace, "open pack");
+        assets.open_pack(options.pack_path);
+    }
 
     // Screen dimensions.
     width = 500;
     height = 640;
 
     // Window and renderer.
-    window = SDL_CreateWindow("Tetris Unleashed!",
-            SDL_WINDOWPOS_UNDEFINED,
-            SDL_WINDOWPOS_UNDEFINED,
-            width,
-            height,
-            SDL_WINDOW_SHOWN);
+    bool scaled = options.scale > 1 || options.fullscreen;
+    Uint32 window_flags = SDL_WINDOW_SHOWN;
+    if (scaled)
+        window_flags |= SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
+    if (options.fullscreen)
+        window_flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+    {
+        StartupTrace::Scope scope(&trace, "window");
+        window = SDL_CreateWindow("Tetris Unleashed!",
+                SDL_WINDOWPOS_UNDEFINED,
+                SDL_WINDOWPOS_UNDEFINED,
+                width*options.scale,
+                height*options.scale,
+                window_flags);
+    }
 
-    renderer = SDL_CreateRenderer(window, -1,
-            SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    pacer.init(options.pacing, options.fps);
+    Uint32 flags = SDL_RENDERER_ACCELERATED;
+    if (pacer.vsync())
+        flags |= SDL_RENDERER_PRESENTVSYNC;
+    {
+        StartupTrace::Scope scope(&trace, "renderer");
+        renderer = SDL_CreateRenderer(window, -1, flags);
+    }
+
+    // Logical resolution: the scene is drawn at width x height, whatever
+    // the window or display density, and copied once per frame at the
+    // largest whole scale that fits. SDL maps mouse coordinates back to
+    // the scene.
+    scene = nullptr;
+    if (scaled) {
+        StartupTrace::Scope scope(&trace, "scene target");
+        scene = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                SDL_TEXTUREACCESS_TARGET, width, height);
+        SDL_SetTextureScaleMode(scene, SDL_ScaleModeNearest);
+        SDL_RenderSetLogicalSize(renderer, width, height);
+        SDL_RenderSetIntegerScale(renderer, SDL_TRUE);
+    }
+
+    profiler.init();
+    profiler_text = nullptr;
+    presented = false;
 
+    // Frames are captured at the scene's size when there is one.
+    if (!options.capture_path.empty()) {
+        int output_width = width, output_height = height;
+        if (scene == nullptr)
+            SDL_GetRendererOutputSize(renderer,
+                    &output_width, &output_height);
+        capture.start(options.capture_path, output_width, output_height);
+    }
+
+    transition = NONE;
+    next_state = nullptr;
+    transition_pending = false;
     exit = false;
 }
 
 void GameEngine::execute() {
+    apply_transition();
     while (!exit) {
-        input();
-        update();
-        render();
+        if (options.threaded && states.back()->threaded()) {
+            execute_threaded();
+        } else {
+            pacer.wait_for_events(states.back()->idle());
+            profiler.begin_frame();
+            {
+                FrameProfiler::Scope scope(&profiler, FrameProfiler::INPUT);
+                input();
+            }
+            {
+                FrameProfiler::Scope scope(&profiler, FrameProfiler::UPDATE);
+                update();
+            }
+            {
+                FrameProfiler::Scope scope(&profiler, FrameProfiler::RENDER);
+                render();
+            }
+            present();
+            pacer.end_frame();
+            profiler.end_frame();
+        }
+        apply_transition();
     }
     clean_up();
 }
 
+// Renders on this thread while another one simulates. Only the main thread
+// may poll events and draw, so events are forwarded to the simulation and
+// frames are drawn from the state's latest snapshot. Rendering blocking on
+// vsync no longer holds the simulation back. Returns, once the simulation
+// has stopped, when a state change is requested.
+void GameEngine::execute_threaded() {
+    GameState* state = states.back();
+    std::thread simulation(&GameEngine::simulate, this, state);
+
+    SDL_Event event;
+    std::vector<SDL_Event> polled;
+    while (!exit && !transition_pending) {
+        pacer.wait_for_events(state->idle());
+        profiler.begin_frame();
+        {
+            FrameProfiler::Scope scope(&profiler, FrameProfiler::INPUT);
+            polled.clear();
+            while (SDL_PollEvent(&event))
+                polled.push_back(event);
+            if (!polled.empty()) {
+                std::lock_guard<std::mutex> lock(event_lock);
+                events.insert(events.end(), polled.begin(), polled.end());
+            }
+        }
+        {
+            FrameProfiler::Scope scope(&profiler, FrameProfiler::RENDER);
+            render();
+        }
+        present();
+        pacer.end_frame();
+        profiler.end_frame();
+    }
+
+    simulation.join();
+}
+
+// Simulation thread: TICKS_PER_SECOND updates of state until quit().
+void GameEngine::simulate(GameState* state) {
+    typedef std::chrono::steady_clock clock;
+    const clock::duration tick = std::chrono::duration_cast<clock::duration>(
+            std::chrono::seconds(1)) / TICKS_PER_SECOND;
+
+    std::vector<SDL_Event> pending;
+    clock::time_point next = clock::now();
+    while (!exit && !transition_pending) {
+        {
+            std::lock_guard<std::mutex> lock(event_lock);
+            pending.swap(events);
+        }
+        for (size_t i = 0; i < pending.size(); i++)
+            state->handle_event(this, pending[i]);
+        pending.clear();
+
+        {
+            FrameProfiler::Scope scope(&profiler, FrameProfiler::UPDATE);
+            state->update(this);
+        }
+
+        // Don't try to catch up after a stall (e.g. a debugger break).
+        next += tick;
+        clock::time_point now = clock::now();
+        if (next < now)
+            next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
+
 void GameEngine::clean_up() {
-    // Clean up the current state.
+    profiler.destroy();
+
+    if (capture.active()) {
+        capture.stop();
+        std::cerr << capture.captured() << " frames captured, "
+            << capture.dropped() << " dropped" << std::endl;
+    }
+
+    if (scene != nullptr)
+        SDL_DestroyTexture(scene);
+    scene = nullptr;
+
+    // Leave the stacked states, then free what every state loaded.
     while (!states.empty()) {
-        states.back()->clean_up(this);
+        states.back()->exit(this);
         states.pop_back();
     }
+    for (size_t i = resident.size(); i-- > 0; )
+        resident[i]->unload(this);
+    resident.clear();
 
+    // States only borrow assets, the renderer goes once they are freed.
+    assets.release(profiler_text);
+    assets.clear();
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+
+    TTF_Quit();
+    IMG_Quit();
     SDL_Quit();
+
+    if (trace.is_enabled() && !trace.write(options.startup_trace_path))
+        std::cerr << "cannot write " << options.startup_trace_path
+            << std::endl;
 }
 
 void GameEngine::change_state(GameState* state) {
-    // Clean up the current state.
-    if (!states.empty()) {
-        states.back()->clean_up(this);
-        states.pop_back();
-    }
-
-    // Store and initialize the new state.
-    states.push_back(state);
-    states.back()->init(this);
+    request(CHANGE, state);
 }
 
 void GameEngine::push_state(GameState* state) {
-    // Pause current state.
-    if ( !states.empty() )
-        states.back()->pause();
-
-    // Store and initialize the new state.
-    states.push_back(state);
-    states.back()->init(this);
+    request(PUSH, state);
 }
 
 void GameEngine::pop_state() {
-    // Clean up the current state.
-    if ( !states.empty() ) {
-        states.back()->clean_up(this);
-        states.pop_back();
+    request(POP, nullptr);
+}
+
+void GameEngine::request(Transition transition, GameState* state) {
+    std::lock_guard<std::mutex> lock(transition_lock);
+    this->transition = transition;
+    next_state = state;
+    transition_pending = true;
+}
+
+void GameEngine::apply_transition() {
+    Transition applied;
+    GameState* state;
+    {
+        std::lock_guard<std::mutex> lock(transition_lock);
+        applied = transition;
+        state = next_state;
+        transition = NONE;
+        next_state = nullptr;
+        transition_pending = false;
     }
 
-    // Resume previous state.
-    if ( !states.empty() )
-        states.back()->resume();
+    switch (applied) {
+        case CHANGE:
+            // Leave the current state, it stays loaded.
+            if (!states.empty()) {
+                states.back()->exit(this);
+                states.pop_back();
+            }
+            enter(state);
+            break;
+        case PUSH:
+            // Pause current state.
+            if (!states.empty())
+                states.back()->pause();
+            enter(state);
+            break;
+        case POP:
+            if (!states.empty()) {
+                states.back()->exit(this);
+                states.pop_back();
+            }
+
+            // Resume previous state, or stop with none left.
+            if (!states.empty())
+                states.back()->resume();
+            else
+                exit = true;
+            break;
+        default:
+            break;
+    }
 }
 
+// Makes state current, loading it the first time.
+void GameEngine::enter(GameState* state) {
+    if (std::find(resident.begin(), resident.end(), state) ==
+            resident.end()) {
+        if (!state->load(this)) {
+            // Missing or broken resources, reported by the cache.
+            state->unload(this);
+            exit = true;
+            return;
+        }
+        resident.push_back(state);
+    }
+    states.push_back(state);
+    state->enter(this);
+}
 
 void GameEngine::input() {
     // Let the state handle events.
@@ -91,6 +317,41 @@ void GameEngine::update() {
 }
 
 void GameEngine::render() {
+    if (scene != nullptr)
+        SDL_SetRenderTarget(renderer, scene);
+
     // Let the state draw the screen.
     states.back()->render(this);
+
+    // Overlays. Most runs never show the profiler, its font is loaded
+    // when it first is.
+    if (profiler.visible()) {
+        if (profiler_text == nullptr)
+            profiler_text = assets.glyphs("resources/fonts/bitwise.ttf", 12,
+                    renderer);
+        profiler.render(renderer, profiler_text);
+    }
+}
+
+void GameEngine::present() {
+    // The back buffer is undefined once presented.
+    if (capture.active())
+        capture.capture(renderer);
+
+    // Scale the scene up to the window, letterboxed.
+    if (scene != nullptr) {
+        SDL_SetRenderTarget(renderer, nullptr);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, scene, nullptr, nullptr);
+        FrameProfiler::count_draw_calls();
+    }
+
+    // Swap buffers.
+    SDL_RenderPresent(renderer);
+
+    if (!presented) {
+        trace.first_frame();
+        presented = true;
+    }
 }
@@ -5,16 +5,30 @@
 
 #include <SDL2/SDL.h>
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 
+#include "src/asset_cache.h"
+#include "src/frame_capture.h"
+#include "src/frame_pacer.h"
+#include "src/options.h"
+#include "src/primitive_batch.h"
+#include "src/profiler.h"
+#include "src/startup_trace.h"
+
 class GameState;
 
 class GameEngine {
  public:
-    GameEngine();
+    explicit GameEngine(const Options& options);
 
     void clean_up();
 
+    // State changes are applied once the current frame is done, on the
+    // main thread, so states may ask for them from update() on either
+    // thread. A later request replaces one not applied yet. States are
+    // loaded when first entered and stay loaded until clean_up().
     void change_state(GameState* state);
     void push_state(GameState* state);
     void pop_state();
@@ -23,6 +37,10 @@ class GameEngine {
     void input();
     void update();
     void render();
+    void present();
+
+    // Simulation rate of the threaded mode.
+    static const int TICKS_PER_SECOND = 120;
 
     bool running() { return !exit; }
     void quit() { exit = true; }
@@ -37,11 +55,61 @@ class GameEngine {
     SDL_Window* window;
     SDL_Renderer* renderer;
 
+    // With --scale or --fullscreen, states draw into this width x height
+    // target, which present() scales up to the window. Null otherwise.
+    SDL_Texture* scene;
+
+    // Command line options.
+    Options options;
+
+    // Init phases up to the first frame, with options.startup_trace_path.
+    StartupTrace trace;
+
+    // Fonts, textures and sounds, shared by the states.
+    AssetCache assets;
+
+    // Lines and rectangles, shared by the states. Drawn when a state
+    // flushes it.
+    PrimitiveBatch primitives;
+
+    // Frame timings, shown with F3.
+    FrameProfiler profiler;
+
+    // Waits between frames according to options.pacing.
+    FramePacer pacer;
+
+    // Records frames when options.capture_path is set.
+    FrameCapture capture;
+
  private:
     // Stack of states.
     std::vector<GameState*> states;
+    // Every state loaded so far, in load order.
+    std::vector<GameState*> resident;
+
+    enum Transition { NONE, CHANGE, PUSH, POP };
+    void request(Transition transition, GameState* state);
+    void apply_transition();
+    void enter(GameState* state);
+
+    // Requested state change, guarded by transition_lock.
+    std::mutex transition_lock;
+    Transition transition;
+    GameState* next_state;
+    std::atomic<bool> transition_pending;
+
+    void execute_threaded();
+    void simulate(GameState* state);
+
+    // Events polled by the main thread for the simulation thread.
+    std::mutex event_lock;
+    std::vector<SDL_Event> events;
+
+    std::atomic<bool> exit;
+
+    GlyphAtlas* profiler_text;  // Borrowed from assets once F3 is pressed.
 
-    bool exit;
+    bool presented;  // A frame was presented.
 };
 
 #endif  // SRC_GAME_ENGINE_H_
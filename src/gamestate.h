@@ -5,10 +5,27 @@
 
 #include "src/game_engine.h"
 
+// States stay resident once loaded, so that switching between them costs
+// no more than a frame:
+//
+//   load()    Heavy resources (textures, fonts, sounds...), before the
+//             state is first entered. Returns false when the state cannot
+//             run without one that failed to load; the engine then
+//             unloads it and quits.
+//   enter()   Each time the state becomes current, e.g. a new game.
+//   pause()   Another state was pushed on top of this one.
+//   resume()  That state was popped.
+//   exit()    Each time the state stops being current (changed or popped).
+//   unload()  Frees what load() took, when the engine shuts down.
+//
+// All of them run on the main thread, between frames.
 class GameState {
  public:
-    virtual void init(GameEngine* game) = 0;
-    virtual void clean_up(GameEngine* game) = 0;
+    virtual bool load(GameEngine* game) = 0;
+    virtual void unload(GameEngine* game) = 0;
+
+    virtual void enter(GameEngine* game) = 0;
+    virtual void exit(GameEngine* game) = 0;
 
     virtual void pause() = 0;
     virtual void resume() = 0;
@@ -17,6 +34,20 @@ class GameState {
     virtual void update(GameEngine* game) = 0;
     virtual void render(GameEngine* game) = 0;
 
+    // True while frames would all look the same until the next event
+    // (paused, menus...). Lets --pacing idle sleep instead of redrawing.
+    // Called on the main thread.
+    virtual bool idle() { return false; }
+
+    // Threaded engine mode (--threaded). A state returning true has
+    // update() called on a simulation thread and render() on the main
+    // thread. It must then take events through handle_event() (called on
+    // the simulation thread) and render only from snapshots published by
+    // update(). State changes requested from update() wait for the
+    // simulation thread to stop.
+    virtual bool threaded() { return false; }
+    virtual void handle_event(GameEngine* game, const SDL_Event& event) { }
+
     void change_state(GameEngine* game, GameState* state) {
         game->change_state(state);
     }
@@ -0,0 +1,121 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/glyph_atlas.h"
+
+#include <algorithm>
+
+bool GlyphAtlas::build(TTF_Font* font, SDL_Renderer* renderer) {
+    return upload(build_pixels(font), renderer);
+}
+
+bool GlyphAtlas::upload(SDL_Surface* atlas, SDL_Renderer* renderer) {
+    if (atlas == nullptr)
+        return false;
+
+    // Upload them once.
+    texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    SDL_FreeSurface(atlas);
+    if (texture == nullptr)
+        return false;
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+SDL_Surface* GlyphAtlas::build_pixels(TTF_Font* font) {
+    destroy();
+
+    const int atlas_width = 256;
+    const int count = LAST - FIRST + 1;
+    const SDL_Color white = { 255, 255, 255, 255 };
+
+    // Render every glyph and lay them out in rows, 1 pixel apart.
+    SDL_Surface* rendered[count];
+    int x = 0, y = 0, row_height = 0;
+    for (int i = 0; i < count; i++) {
+        Uint16 c = FIRST + i;
+        glyphs[i].advance = 0;
+        TTF_GlyphMetrics(font, c, nullptr, nullptr, nullptr, nullptr,
+                &glyphs[i].advance);
+
+        rendered[i] = TTF_RenderGlyph_Blended(font, c, white);
+        if (rendered[i] == nullptr) {
+            glyphs[i].src = { 0, 0, 0, 0 };
+            continue;
+        }
+
+        int w = rendered[i]->w, h = rendered[i]->h;
+        if (x + w > atlas_width) {
+            x = 0;
+            y += row_height + 1;
+            row_height = 0;
+        }
+        glyphs[i].src = { x, y, w, h };
+        x += w + 1;
+        row_height = std::max(row_height, h);
+    }
+
+    // Copy them into one surface.
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0,
+            atlas_width, y + row_height, 32, SDL_PIXELFORMAT_ARGB8888);
+    for (int i = 0; i < count; i++) {
+        if (rendered[i] == nullptr)
+            continue;
+        if (atlas != nullptr) {
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i], nullptr, atlas, &glyphs[i].src);
+        }
+        SDL_FreeSurface(rendered[i]);
+    }
+    if (atlas == nullptr)
+        return nullptr;
+
+    line_height = TTF_FontHeight(font);
+    return atlas;
+}
+
+void GlyphAtlas::destroy() {
+    if (texture != nullptr) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+}
+
+int GlyphAtlas::draw(SpriteBatch* batch, const char* text, int x, int y,
+        SDL_Color color) const {
+    int pen = x;
+    for (const char* c = text; *c; c++) {
+        const Glyph& g = glyph(*c);
+        if (g.src.w > 0) {
+            SDL_Rect dst = { pen, y, g.src.w, g.src.h };
+            batch->add(g.src, dst, color);
+        }
+        pen += g.advance;
+    }
+    return pen - x;
+}
+
+int GlyphAtlas::draw_number(SpriteBatch* batch, long value, int x, int y,
+        SDL_Color color) const {
+    // Digits are written backwards into a small buffer, no std::string.
+    char digits[24];
+    char* p = digits + sizeof(digits) - 1;
+    *p = '\0';
+
+    unsigned long magnitude = value < 0 ?
+        0ul - static_cast<unsigned long>(value) : value;
+    do {
+        *--p = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+        *--p = '-';
+
+    return draw(batch, p, x, y, color);
+}
+
+int GlyphAtlas::width(const char* text) const {
+    int w = 0;
+    for (const char* c = text; *c; c++)
+        w += glyph(*c).advance;
+    return w;
+}
@@ -0,0 +1,71 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_GLYPH_ATLAS_H_
+#define SRC_GLYPH_ATLAS_H_
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "src/sprite_batch.h"
+
+// Printable ASCII glyphs of one font and size, rasterized once into a
+// single texture. Strings are drawn as quads through a SpriteBatch, so
+// changing text (scores, timings) costs neither allocations nor texture
+// uploads, unlike render_text().
+class GlyphAtlas {
+ public:
+    GlyphAtlas() : texture(nullptr), line_height(0) { }
+    ~GlyphAtlas() { destroy(); }
+
+    // Rasterizes the glyphs of font, in white. Returns false on failure.
+    bool build(TTF_Font* font, SDL_Renderer* renderer);
+    // Same, but returns the glyphs as an ARGB8888 surface owned by the
+    // caller instead of uploading them, for software rendering. Returns
+    // null on failure.
+    SDL_Surface* build_pixels(TTF_Font* font);
+    // Uploads and frees the surface of build_pixels(), which may run on
+    // another thread. Returns false on failure.
+    bool upload(SDL_Surface* pixels, SDL_Renderer* renderer);
+    void destroy();
+
+    // Texture to begin the SpriteBatch with before drawing.
+    SDL_Texture* get_texture() const { return texture; }
+    int height() const { return line_height; }
+
+    // Queue text at (x, y), upper left corner, tinted with color. Return
+    // the width of the text in pixels.
+    int draw(SpriteBatch* batch, const char* text, int x, int y,
+            SDL_Color color = SDL_Color{255, 255, 255, 255}) const;
+    int draw_number(SpriteBatch* batch, long value, int x, int y,
+            SDL_Color color = SDL_Color{255, 255, 255, 255}) const;
+
+    // Width of text in pixels.
+    int width(const char* text) const;
+
+    // Where a character is in the atlas (empty if it has no pixels) and
+    // how far it moves the pen, for drawing without a SpriteBatch.
+    const SDL_Rect& source(char c) const { return glyph(c).src; }
+    int advance(char c) const { return glyph(c).advance; }
+
+ private:
+    GlyphAtlas(const GlyphAtlas&);
+    GlyphAtlas& operator=(const GlyphAtlas&);
+
+    static const char FIRST = ' ';
+    static const char LAST = '~';
+
+    struct Glyph {
+        SDL_Rect src;  // Empty for glyphs without pixels (space).
+        int advance;
+    };
+
+    const Glyph& glyph(char c) const {
+        return glyphs[(c < FIRST || c > LAST ? '?' : c) - FIRST];
+    }
+
+    SDL_Texture* texture;
+    Glyph glyphs[LAST - FIRST + 1];
+    int line_height;
+};
+
+#endif  // SRC_GLYPH_ATLAS_H_
@@ -0,0 +1,17 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_HASH_H_
+#define SRC_HASH_H_
+
+#include <stdint.h>
+
+// Scrambles a 64-bit value (splitmix64 finalizer). Used to derive
+// Zobrist keys and to combine hashes of game state.
+inline uint64_t hash_mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+#endif  // SRC_HASH_H_
@@ -6,16 +6,36 @@
 
 IntroState IntroState::m_introstate;
 
-void IntroState::init(GameEngine* game) {
-    logo = load_texture("resources/images/logo.png", game->renderer);
-    exit = false;
+bool IntroState::load(GameEngine* game) {
+    logo = game->assets.texture("resources/images/logo.png", game->renderer);
+
+    // Load what the menu and the game use while the logo shows.
+    game->assets.preload_font("resources/fonts/Basica.ttf", 32);
+    game->assets.preload_font("resources/fonts/Basica.ttf", 16);
+    game->assets.preload_glyphs("resources/fonts/bitwise.ttf", 16,
+            game->renderer);
+    game->assets.preload_glyphs("resources/fonts/bitwise.ttf", 20,
+            game->renderer);
+    game->assets.preload_sprites("resources/sprites/atlas.txt",
+            game->renderer);
+    game->assets.preload_sound("resources/sounds/Dubmood-Tetris.ogg");
+
+    // Without a logo there is nothing to fade, but the game still runs.
+    return true;
+}
+
+void IntroState::unload(GameEngine* game) {
+    game->assets.release(logo);
+}
+
+void IntroState::enter(GameEngine* game) {
+    quitting = false;
     alpha = 1;
     logo_status = FADE_IN;
+    remain_start = 0;
 }
 
-void IntroState::clean_up(GameEngine* game) {
-    IMG_Quit();
-}
+void IntroState::exit(GameEngine* game) {}
 
 void IntroState::pause() {}
 
@@ -28,13 +48,13 @@ void IntroState::input(GameEngine* game) {
     while (SDL_PollEvent(&event)) {
         // Clicking 'x' or pressing F4.
         if (event.type == SDL_QUIT)
-            exit = true;
+            quitting = true;
 
         // Key is pressed.
         if (event.type == SDL_KEYDOWN) {
             switch (event.key.keysym.sym) {
                 case SDLK_ESCAPE:
-                    exit = true;
+                    quitting = true;
                     break;
                 default:
                     break;
@@ -44,7 +64,7 @@ void IntroState::input(GameEngine* game) {
 }
 
 void IntroState::update(GameEngine* game) {
-    if (exit) {
+    if (quitting) {
         game->quit();
     }
 
@@ -59,21 +79,23 @@ void IntroState::render(GameEngine* game) {
     SDL_RenderClear(game->renderer);
 
     render_logo(game);
-
-    // Swap buffers.
-    SDL_RenderPresent(game->renderer);
 }
 
 void IntroState::render_logo(GameEngine* game) {
+    // Upload what the loading thread has finished.
+    bool loaded = game->assets.poll();
+
     if (logo_status == FADE_IN) {
         alpha += 3;
         if (alpha >= 255) {
             alpha = 255;
             logo_status = REMAIN;
+            remain_start = SDL_GetTicks();
         }
     } else if (logo_status == REMAIN) {
-        SDL_Delay(2000);
-        logo_status = FADE_OUT;
+        // Show the logo for 2 seconds, longer if loading isn't done.
+        if (loaded && SDL_GetTicks() - remain_start >= 2000)
+            logo_status = FADE_OUT;
     } else if (logo_status == FADE_OUT) {
         alpha -= 3;
         if (alpha <= 0) {
@@ -84,10 +106,19 @@ void IntroState::render_logo(GameEngine* game) {
 
     SDL_SetTextureAlphaMod(logo, alpha);
 
-    int logo_width, logo_height;
+    int logo_width = 0, logo_height = 0;
     SDL_QueryTexture(logo, nullptr, nullptr, &logo_width, &logo_height);
     int x = game->width / 2 - logo_width / 2;
     int y = game->height / 2 - logo_height / 2;
 
     render_texture(logo, game->renderer, x, y);
+
+    // Loading progress, under the logo.
+    if (!loaded) {
+        SDL_Rect bar = { x, y + logo_height + 10,
+            static_cast<int>(logo_width*game->assets.progress()), 2 };
+        game->primitives.fill(bar,
+                SDL_Color{255, 255, 255, static_cast<Uint8>(alpha)});
+        game->primitives.flush(game->renderer);
+    }
 }
@@ -10,8 +10,11 @@
 
 class IntroState : public GameState {
  public:
-    void init(GameEngine* game);
-    void clean_up(GameEngine* game);
+    bool load(GameEngine* game);
+    void unload(GameEngine* game);
+
+    void enter(GameEngine* game);
+    void exit(GameEngine* game);
 
     void pause();
     void resume();
@@ -31,13 +34,14 @@ class IntroState : public GameState {
  private:
     static IntroState m_introstate;
 
-    bool exit;
+    bool quitting;
 
     // Logo
     SDL_Texture* logo;
     int alpha;
     enum Status {FADE_IN, REMAIN, FADE_OUT};
     Status logo_status;
+    Uint32 remain_start;  // SDL_GetTicks() when the logo stopped fading in.
 };
 
 #endif  // SRC_INTROSTATE_H_
@@ -3,9 +3,18 @@
 
 #include "src/game_engine.h"
 #include "src/introstate.h"
+#include "src/options.h"
+#include "src/spectatorstate.h"
 
 int main(int argc, char *argv[]) {
-    GameEngine game;
-    game.change_state(IntroState::Instance());
+    Options options;
+    if (!parse_options(argc, argv, &options))
+        return 1;
+
+    GameEngine game(options);
+    if (options.spectate_games > 0)
+        game.change_state(SpectatorState::Instance());
+    else
+        game.change_state(IntroState::Instance());
     game.execute();
 }
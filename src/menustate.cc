@@ -6,18 +6,20 @@
 
 MenuState MenuState::m_menustate;
 
-void MenuState::init(GameEngine* game) {
-    play = false;
-    exit = false;
-
-    // Initialize fonts and font color.
-    TTF_Init();
+bool MenuState::load(GameEngine* game) {
+    // Font color.
     white = { 255, 255, 255 };
 
-    // Load fonts and font textures.
-    font_title = TTF_OpenFont("resources/fonts/Basica.ttf", 32);
-    font_play = TTF_OpenFont("resources/fonts/Basica.ttf", 16);
-    font_quit = TTF_OpenFont("resources/fonts/Basica.ttf", 16);
+    // Fonts are shared through the asset cache, play and quit use the
+    // same one.
+    font_title = game->assets.font("resources/fonts/Basica.ttf", 32);
+    font_play = game->assets.font("resources/fonts/Basica.ttf", 16);
+    font_quit = game->assets.font("resources/fonts/Basica.ttf", 16);
+    font_image_title = nullptr;
+    font_image_play = nullptr;
+    font_image_quit = nullptr;
+    if (font_title == nullptr || font_play == nullptr || font_quit == nullptr)
+        return false;
 
     font_image_title = render_text("Tetris", white, font_title, game->renderer);
     font_image_play = render_text("Play", white, font_play, game->renderer);
@@ -31,27 +33,39 @@ void MenuState::init(GameEngine* game) {
     SDL_QueryTexture(font_image_quit,
             nullptr, nullptr, &quit_width, &quit_height);
 
-    currently_selected = 0;
     items = 2;
+    return true;
 }
 
-void MenuState::clean_up(GameEngine* game) {
-    // Close all fonts.
-    TTF_CloseFont(font_title);
-    TTF_CloseFont(font_play);
-    TTF_CloseFont(font_quit);
+void MenuState::unload(GameEngine* game) {
+    // Give the fonts back.
+    game->assets.release(font_title);
+    game->assets.release(font_play);
+    game->assets.release(font_quit);
 
     // Destroy all textures.
-    SDL_DestroyTexture(font_image_title);
-    SDL_DestroyTexture(font_image_play);
-    SDL_DestroyTexture(font_image_quit);
+    if (font_image_title != nullptr)
+        SDL_DestroyTexture(font_image_title);
+    if (font_image_play != nullptr)
+        SDL_DestroyTexture(font_image_play);
+    if (font_image_quit != nullptr)
+        SDL_DestroyTexture(font_image_quit);
+}
 
-    IMG_Quit();
+void MenuState::enter(GameEngine* game) {
+    play = false;
+    quitting = false;
+    currently_selected = 0;
 }
 
+void MenuState::exit(GameEngine* game) {}
+
 void MenuState::pause() {}
 
-void MenuState::resume() {}
+// Back from a game.
+void MenuState::resume() {
+    play = false;
+}
 
 void MenuState::reset() {}
 
@@ -60,14 +74,14 @@ void MenuState::input(GameEngine* game) {
     while (SDL_PollEvent(&event)) {
         // Clicking 'x' or pressing F4.
         if (event.type == SDL_QUIT)  {
-            exit = true;
+            quitting = true;
         }
 
         // Key is pressed.
         if (event.type == SDL_KEYDOWN) {
             switch (event.key.keysym.sym) {
                 case SDLK_ESCAPE:
-                    exit = true;
+                    quitting = true;
                     break;
                 case SDLK_UP:
                     select_up();
@@ -79,7 +93,7 @@ void MenuState::input(GameEngine* game) {
                     if (currently_selected == 0)
                         play = true;
                     else if (currently_selected == 1)
-                        exit = true;
+                        quitting = true;
                     break;
                 default:
                     break;
@@ -91,7 +105,7 @@ void MenuState::input(GameEngine* game) {
 void MenuState::update(GameEngine* game) {
     if (play) {
         game->push_state(PlayState::Instance());
-    } else if (exit) {
+    } else if (quitting) {
         game->quit();
     }
 }
@@ -111,15 +125,6 @@ void MenuState::render(GameEngine* game) {
             (game->width - title_width)/2,
             (game->height - title_height)/2-space*2);
 
-    // Underline the selected item.
-    if (currently_selected == 0) {
-        TTF_SetFontStyle(font_play, TTF_STYLE_UNDERLINE);
-        font_image_play = render_text("Play", white, font_play, game->renderer);
-    } else if (currently_selected == 1) {
-        TTF_SetFontStyle(font_quit, TTF_STYLE_UNDERLINE);
-        font_image_quit = render_text("Quit", white, font_quit, game->renderer);
-    }
-
     // Draw menu items (centered).
     render_texture(font_image_play, game->renderer,
             (game->width - play_width)/2, (game->height - play_height)/2);
@@ -127,17 +132,20 @@ void MenuState::render(GameEngine* game) {
             (game->width - quit_width)/2,
             (game->height - quit_height)/2+space);
 
-    // Remove underline again.
+    // Underline the selected item.
+    SDL_Rect underline;
     if (currently_selected == 0) {
-        TTF_SetFontStyle(font_play, TTF_STYLE_NORMAL);
-        font_image_play = render_text("Play", white, font_play, game->renderer);
-    } else if (currently_selected == 1) {
-        TTF_SetFontStyle(font_quit, TTF_STYLE_NORMAL);
-        font_image_quit = render_text("Quit", white, font_quit, game->renderer);
+        underline = { (game->width - play_width)/2,
+            (game->height - play_height)/2 + TTF_FontAscent(font_play) + 2,
+            play_width, 1 };
+    } else {
+        underline = { (game->width - quit_width)/2,
+            (game->height - quit_height)/2+space +
+                TTF_FontAscent(font_quit) + 2,
+            quit_width, 1 };
     }
-
-    // Swap buffers.
-    SDL_RenderPresent(game->renderer);
+    game->primitives.fill(underline, SDL_Color{255, 255, 255, 255});
+    game->primitives.flush(game->renderer);
 }
 
 void MenuState::select_up() {
@@ -10,8 +10,11 @@
 
 class MenuState : public GameState {
  public:
-    void init(GameEngine* game);
-    void clean_up(GameEngine* game);
+    bool load(GameEngine* game);
+    void unload(GameEngine* game);
+
+    void enter(GameEngine* game);
+    void exit(GameEngine* game);
 
     void pause();
     void resume();
@@ -21,6 +24,9 @@ class MenuState : public GameState {
     void update(GameEngine* game);
     void render(GameEngine* game);
 
+    // The menu only changes on input.
+    bool idle() { return true; }
+
     // Navigate through menu items.
     void select_up();
     void select_down();
@@ -34,7 +40,7 @@ class MenuState : public GameState {
     static MenuState m_menustate;
 
     bool play;
-    bool exit;
+    bool quitting;
 
     // Font textures.
     SDL_Color       white;
@@ -0,0 +1,94 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/movegen.h"
+
+#include "src/tetromino.h"
+
+namespace {
+    // Rotated coordinates of every tetromino, computed once.
+    struct CoordsTable {
+        int coords[7][4][Tetromino::SIZE][2];
+
+        CoordsTable() {
+            for (int t = 0; t < 7; t++)
+                for (int r = 0; r < 4; r++)
+                    Tetromino::rotated_coords(t, r, coords[t][r]);
+        }
+    };
+
+    const CoordsTable& table() {
+        static const CoordsTable t;
+        return t;
+    }
+
+    // Identifies the cells covered by a placement: the 4 cell indices, in
+    // increasing order, packed 9 bits each.
+    uint64_t cells_key(const int coords[][2], int x, int y) {
+        int cells[Tetromino::SIZE];
+        for (int i = 0; i < Tetromino::SIZE; i++) {
+            int cell = (y + coords[i][1] + 2)*Board::COLS + x + coords[i][0];
+            int j = i;
+            for (; j > 0 && cells[j-1] > cell; j--)
+                cells[j] = cells[j-1];
+            cells[j] = cell;
+        }
+
+        uint64_t key = 0;
+        for (int i = 0; i < Tetromino::SIZE; i++)
+            key = (key << 9) | cells[i];
+        return key;
+    }
+}
+
+bool collides(const Board& board, int type, int rot, int x, int y) {
+    const int (*coords)[2] = table().coords[type][rot & 3];
+    for (int i = 0; i < Tetromino::SIZE; i++) {
+        int block_x = x + coords[i][0];
+        int block_y = y + coords[i][1];
+        if (block_x < 0 || block_x >= Board::COLS || block_y >= Board::ROWS)
+            return true;
+        if (block_y >= 0 && board.color[block_y][block_x] != -1)
+            return true;
+    }
+    return false;
+}
+
+int generate_placements(const Board& board, int type, Placement out[]) {
+    uint64_t keys[MAX_PLACEMENTS];
+    int count = 0;
+
+    for (int rot = 0; rot < 4; rot++) {
+        const int (*coords)[2] = table().coords[type][rot];
+        for (int x = -2; x < Board::COLS + 2; x++) {
+            // The piece is rotated and shifted on the spawn row.
+            if (collides(board, type, rot, x, 0))
+                continue;
+
+            int y = 0;
+            while (!collides(board, type, rot, x, y + 1))
+                y++;
+
+            uint64_t key = cells_key(coords, x, y);
+            bool seen = false;
+            for (int k = 0; k < count && !seen; k++)
+                seen = keys[k] == key;
+            if (seen)
+                continue;
+
+            keys[count] = key;
+            out[count].rot = rot;
+            out[count].x = x;
+            out[count].y = y;
+            count++;
+        }
+    }
+    return count;
+}
+
+bool apply_placement(Board* board, int type, const Placement& placement) {
+    if (!board->add(type, table().coords[type][placement.rot & 3],
+                placement.x, placement.y))
+        return false;
+    board->delete_full_rows();
+    return true;
+}
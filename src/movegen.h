@@ -0,0 +1,37 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_MOVEGEN_H_
+#define SRC_MOVEGEN_H_
+
+#include <stdint.h>
+
+#include "src/board.h"
+
+// Where a tetromino comes to rest: rotated right rot times, with its
+// (0, 0) block at (x, y).
+struct Placement {
+    int8_t rot;
+    int8_t x;
+    int8_t y;
+};
+
+// Upper bound on the number of placements of one tetromino.
+const int MAX_PLACEMENTS = 4*Board::COLS;
+
+// Generates every distinct lock position of a tetromino of the given type
+// the way the AI moves pieces: rotate at the spawn row, shift to a column
+// and drop straight down. Placements covering the same cells (e.g. the
+// rotations of the O-Block) are only reported once. Returns the number of
+// placements written to out.
+int generate_placements(const Board& board, int type, Placement out[]);
+
+// True if a tetromino of the given type, rotated right rot times, overlaps
+// the walls, the floor or a locked block at (x, y). Blocks above the board
+// are allowed.
+bool collides(const Board& board, int type, int rot, int x, int y);
+
+// Locks a placement into the board and clears full rows. Returns false if
+// the tetromino touched the upper border (game over, see Board::add).
+bool apply_placement(Board* board, int type, const Placement& placement);
+
+#endif  // SRC_MOVEGEN_H_
@@ -0,0 +1,225 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/observation.h"
+
+#include <cstring>
+
+#include "src/tetromino.h"
+#include "src/board_batch.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const int ROWS = Board::ROWS;
+    const int COLS = Board::COLS;
+    const int MAX_CHANNELS = 7 + 2;
+
+    typedef uint16_t Planes[MAX_CHANNELS][ROWS];
+
+    // Row masks of the cells of one Board::color row equal to value.
+    uint16_t row_equal(const int* row, int value) {
+        uint16_t mask = 0;
+        int col = 0;
+#if defined(__SSE2__)
+        __m128i v = _mm_set1_epi32(value);
+        for (; col + 4 <= COLS; col += 4) {
+            __m128i cells = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(row + col));
+            int bits = _mm_movemask_ps(
+                    _mm_castsi128_ps(_mm_cmpeq_epi32(cells, v)));
+            mask |= bits << col;
+        }
+#endif
+        for (; col < COLS; col++)
+            mask |= (row[col] == value) << col;
+        return mask;
+    }
+
+    void locked_planes(const Board& board, bool per_type, Planes planes) {
+        for (int row = 0; row < ROWS; row++) {
+            if (per_type) {
+                for (int t = 0; t < 7; t++)
+                    planes[t][row] = row_equal(board.color[row], t);
+            } else {
+                planes[0][row] =
+                    ~row_equal(board.color[row], -1) & ((1 << COLS) - 1);
+            }
+        }
+    }
+
+    void piece_plane(int type, int rot, int x, int y, uint16_t* plane) {
+        std::memset(plane, 0, ROWS*sizeof(plane[0]));
+        int coords[4][2];
+        Tetromino::rotated_coords(type, rot, coords);
+        for (int i = 0; i < Tetromino::SIZE; i++) {
+            int bx = x + coords[i][0];
+            int by = y + coords[i][1];
+            if (bx >= 0 && bx < COLS && by >= 0 && by < ROWS)
+                plane[by] |= 1 << bx;
+        }
+    }
+
+    void tetromino_plane(const Tetromino* tetro, uint16_t* plane) {
+        std::memset(plane, 0, ROWS*sizeof(plane[0]));
+        if (tetro == nullptr)
+            return;
+        for (int i = 0; i < Tetromino::SIZE; i++) {
+            int bx = tetro->x + tetro->coords[i][0];
+            int by = tetro->y + tetro->coords[i][1];
+            if (bx >= 0 && bx < COLS && by >= 0 && by < ROWS)
+                plane[by] |= 1 << bx;
+        }
+    }
+
+    // Expands the low COLS bits of mask into COLS bytes of 0 or 1.
+    void expand_bytes(uint16_t mask, uint8_t* out) {
+#if defined(__SSE2__)
+        const __m128i bit = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                1, 2, 4, 8, 16, 32, 64, -128);
+        __m128i v = _mm_unpacklo_epi64(_mm_set1_epi8(mask & 0xff),
+                _mm_set1_epi8(mask >> 8));
+        v = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, bit), bit),
+                _mm_set1_epi8(1));
+        uint8_t tmp[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), v);
+        std::memcpy(out, tmp, COLS);
+#else
+        for (int col = 0; col < COLS; col++)
+            out[col] = (mask >> col) & 1;
+#endif
+    }
+
+    // Expands the low COLS bits of mask into COLS floats of 0 or 1.
+    void expand_floats(uint16_t mask, float* out) {
+#if defined(__SSE2__)
+        const __m128i bit = _mm_setr_epi32(1, 2, 4, 8);
+        const __m128 one = _mm_set1_ps(1.0f);
+        float tmp[16];
+        for (int col = 0; col < 16; col += 4) {
+            __m128i v = _mm_set1_epi32(mask >> col);
+            __m128i set = _mm_cmpeq_epi32(_mm_and_si128(v, bit), bit);
+            _mm_storeu_ps(tmp + col, _mm_and_ps(_mm_castsi128_ps(set), one));
+        }
+        std::memcpy(out, tmp, COLS*sizeof(float));
+#else
+        for (int col = 0; col < COLS; col++)
+            out[col] = static_cast<float>((mask >> col) & 1);
+#endif
+    }
+}
+
+size_t ObservationOptions::size() const {
+    switch (type) {
+        case BITS:
+            return channels()*ROWS*2;
+        case FLOAT32:
+            return channels()*ROWS*COLS*sizeof(float);
+        default:
+            return channels()*ROWS*COLS;
+    }
+}
+
+void write_planes(const uint16_t (*planes)[ROWS], int channels,
+        const ObservationOptions& options, void* out) {
+    if (options.type == ObservationOptions::BITS) {
+        uint8_t* bytes = static_cast<uint8_t*>(out);
+        for (int c = 0; c < channels; c++)
+            for (int row = 0; row < ROWS; row++) {
+                *bytes++ = planes[c][row] & 0xff;
+                *bytes++ = planes[c][row] >> 8;
+            }
+        return;
+    }
+
+    // Channel-major planes are whole rows of consecutive cells, which is
+    // what the SIMD expansion writes.
+    if (options.layout == ObservationOptions::CHW) {
+        for (int c = 0; c < channels; c++)
+            for (int row = 0; row < ROWS; row++) {
+                int offset = (c*ROWS + row)*COLS;
+                if (options.type == ObservationOptions::FLOAT32)
+                    expand_floats(planes[c][row],
+                            static_cast<float*>(out) + offset);
+                else
+                    expand_bytes(planes[c][row],
+                            static_cast<uint8_t*>(out) + offset);
+            }
+        return;
+    }
+
+    // Channel-minor layout interleaves channels per cell.
+    for (int row = 0; row < ROWS; row++)
+        for (int col = 0; col < COLS; col++)
+            for (int c = 0; c < channels; c++) {
+                int offset = (row*COLS + col)*channels + c;
+                int bit = (planes[c][row] >> col) & 1;
+                if (options.type == ObservationOptions::FLOAT32)
+                    static_cast<float*>(out)[offset] = bit;
+                else
+                    static_cast<uint8_t*>(out)[offset] = bit;
+            }
+}
+
+void export_observation(const Board& board,
+        const Tetromino* active, const Tetromino* next,
+        const ObservationOptions& options, void* out) {
+    Planes planes;
+    int locked = options.per_type ? 7 : 1;
+    locked_planes(board, options.per_type, planes);
+    tetromino_plane(active, planes[locked]);
+    if (options.include_next) {
+        // Show the next piece where it will spawn rather than where
+        // PlayState draws it.
+        if (next != nullptr)
+            piece_plane(next->type, 0, COLS/2, 0, planes[locked + 1]);
+        else
+            tetromino_plane(nullptr, planes[locked + 1]);
+    }
+    write_planes(planes, options.channels(), options, out);
+}
+
+void export_observations(const Board* const* boards,
+        const Tetromino* const* active, const Tetromino* const* next,
+        int count, const ObservationOptions& options, void* out) {
+    size_t size = options.size();
+    for (int i = 0; i < count; i++)
+        export_observation(*boards[i],
+                active ? active[i] : nullptr, next ? next[i] : nullptr,
+                options, static_cast<uint8_t*>(out) + i*size);
+}
+
+void export_observations(const BoardBatch& batch, int first, int count,
+        const ObservationOptions& options, void* out) {
+    size_t size = options.size();
+    int locked = options.per_type ? 7 : 1;
+    for (int g = first; g < first + count; g++) {
+        Planes planes;
+        for (int row = 0; row < ROWS; row++) {
+            if (!options.per_type) {
+                planes[0][row] = batch.cells(g, row);
+                continue;
+            }
+            for (int t = 0; t < 7; t++)
+                planes[t][row] = 0;
+            for (int col = 0; col < COLS; col++) {
+                int color = batch.color(g, row, col);
+                if (color >= 0)
+                    planes[color][row] |= 1 << col;
+            }
+        }
+
+        if (batch.game_over[g])
+            tetromino_plane(nullptr, planes[locked]);
+        else
+            piece_plane(batch.type[g], batch.rotation[g],
+                    batch.x[g], batch.y[g], planes[locked]);
+        if (options.include_next)
+            piece_plane(batch.next_type[g], 0, COLS/2, 0,
+                    planes[locked + 1]);
+
+        write_planes(planes, options.channels(), options,
+                static_cast<uint8_t*>(out) + (g - first)*size);
+    }
+}
@@ -0,0 +1,74 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_OBSERVATION_H_
+#define SRC_OBSERVATION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "src/board.h"
+
+class Tetromino;
+class BoardBatch;
+
+// Exports board states as dense planes into caller-owned buffers, e.g.
+// the input tensor of a neural network. Works off Board::color (or the
+// BoardBatch equivalent) and does not touch SDL.
+//
+// Channels, in order:
+//   locked blocks: 1 occupancy channel, or 7 channels (one per tetromino
+//                  type) when per_type is set,
+//   active piece:  blocks of the falling tetromino,
+//   next piece:    blocks of the next tetromino at its spawn position,
+//                  only when include_next is set.
+// Pieces outside the board (e.g. next_tetro in PlayState, drawn next to
+// the board) are clipped.
+struct ObservationOptions {
+    enum Layout {
+        CHW,  // Channel-major: out[(c*ROWS + row)*COLS + col].
+        HWC   // Channel-minor: out[(row*COLS + col)*channels + c].
+    };
+    enum Type {
+        UINT8,    // One 0/1 byte per cell.
+        FLOAT32,  // One 0.0f/1.0f float per cell.
+        BITS      // Per channel, ROWS little-endian 16-bit row masks with
+                  // bit c set if column c is occupied. Layout is ignored.
+    };
+
+    Layout layout;
+    Type type;
+    bool per_type;
+    bool include_next;
+
+    ObservationOptions()
+        : layout(CHW), type(UINT8), per_type(false), include_next(true) { }
+
+    int channels() const { return (per_type ? 7 : 1) + 1 + include_next; }
+
+    // Bytes written per board.
+    size_t size() const;
+};
+
+// Renders one board with its active and next tetromino (either may be
+// null) into out, which must hold options.size() bytes.
+void export_observation(const Board& board,
+        const Tetromino* active, const Tetromino* next,
+        const ObservationOptions& options, void* out);
+
+// Renders count boards; board i is written at offset i*options.size().
+void export_observations(const Board* const* boards,
+        const Tetromino* const* active, const Tetromino* const* next,
+        int count, const ObservationOptions& options, void* out);
+
+// Renders games [first, first+count) of a batch. The next piece is taken
+// from BoardBatch::next_type.
+void export_observations(const BoardBatch& batch, int first, int count,
+        const ObservationOptions& options, void* out);
+
+// Lower level entry point: writes channels planes given as ROWS row masks
+// each (bit c = column c) in the requested format. Used by the functions
+// above and by TetrisEnv.
+void write_planes(const uint16_t (*planes)[Board::ROWS], int channels,
+        const ObservationOptions& options, void* out);
+
+#endif  // SRC_OBSERVATION_H_
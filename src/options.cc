@@ -0,0 +1,74 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/options.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+    void usage(const char* binary) {
+        std::cerr << "usage: " << binary << " [options]\n"
+            "  --checksums FILE   write per-tick state checksums to FILE\n"
+            "  --fixed-step       advance the game by 1/60 s per update\n"
+            "  --spectate N       watch a tournament of N bot games\n"
+            "  --threaded         simulate apart from the render thread\n"
+            "  --pacing MODE      vsync (default), cap, uncapped or idle\n"
+            "  --fps N            frame rate of the cap mode (default 60)\n"
+            "  --capture OUTPUT   record frames as OUTPUT (%06d.png) or\n"
+            "                     raw RGBA frames appended to OUTPUT\n"
+            "  --scale N          window N times the game's size\n"
+            "  --fullscreen       scale the game to the whole screen\n"
+            "  --pack FILE        read assets from FILE (default\n"
+            "                     resources.pak, if present)\n"
+            "  --startup-trace FILE\n"
+            "                     write the startup timeline to FILE\n";
+    }
+}
+
+bool parse_options(int argc, char *argv[], Options* options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--checksums" && i + 1 < argc) {
+            options->checksum_path = argv[++i];
+        } else if (arg == "--fixed-step") {
+            options->fixed_step = true;
+        } else if (arg == "--spectate" && i + 1 < argc) {
+            options->spectate_games = std::atoi(argv[++i]);
+        } else if (arg == "--threaded") {
+            options->threaded = true;
+        } else if (arg == "--pacing" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "vsync") {
+                options->pacing = Options::VSYNC;
+            } else if (mode == "cap") {
+                options->pacing = Options::CAP;
+            } else if (mode == "uncapped") {
+                options->pacing = Options::UNCAPPED;
+            } else if (mode == "idle") {
+                options->pacing = Options::IDLE;
+            } else {
+                std::cerr << "unknown pacing mode: " << mode << std::endl;
+                usage(argv[0]);
+                return false;
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            options->fps = std::atoi(argv[++i]);
+        } else if (arg == "--capture" && i + 1 < argc) {
+            options->capture_path = argv[++i];
+        } else if (arg == "--scale" && i + 1 < argc) {
+            options->scale = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--fullscreen") {
+            options->fullscreen = true;
+        } else if (arg == "--pack" && i + 1 < argc) {
+            options->pack_path = argv[++i];
+        } else if (arg == "--startup-trace" && i + 1 < argc) {
+            options->startup_trace_path = argv[++i];
+        } else {
+            std::cerr << "unknown option: " << arg << std::endl;
+            usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
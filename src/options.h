@@ -0,0 +1,63 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_OPTIONS_H_
+#define SRC_OPTIONS_H_
+
+#include <string>
+
+// Command line options of the game.
+struct Options {
+    enum Pacing {
+        VSYNC,     // Wait for the display when presenting (default).
+        CAP,       // At most fps frames per second, without vsync.
+        UNCAPPED,  // As fast as possible.
+        IDLE       // VSYNC, and sleep until input while nothing changes.
+    };
+
+    // Write a per-tick checksum stream to this file (--checksums FILE).
+    std::string checksum_path;
+
+    // Advance gravity by a fixed 1/60 s per update instead of wall-clock
+    // time, so that runs are reproducible (--fixed-step).
+    bool fixed_step;
+
+    // Watch this many bot games instead of playing (--spectate N).
+    int spectate_games;
+
+    // Run the simulation on its own thread, decoupled from rendering and
+    // vsync, in states that support it (--threaded).
+    bool threaded;
+
+    // Frame pacing (--pacing vsync|cap|uncapped|idle) and the frame rate
+    // of the cap mode (--fps N).
+    Pacing pacing;
+    int fps;
+
+    // Record every presented frame (--capture OUTPUT), see FrameCapture.
+    std::string capture_path;
+
+    // Window size as a multiple of the game's 500x640 (--scale N), or the
+    // whole screen (--fullscreen). Either draws the game at its own size
+    // and scales it up by a whole factor in one copy.
+    int scale;
+    bool fullscreen;
+
+    // Asset pack to read resources from (--pack FILE), see AssetPack.
+    // Loose files under resources/ are used when it doesn't exist.
+    std::string pack_path;
+
+    // Write when each startup phase ran, up to the first frame, to this
+    // file on exit (--startup-trace FILE), see StartupTrace.
+    std::string startup_trace_path;
+
+    Options()
+        : fixed_step(false), spectate_games(0), threaded(false),
+          pacing(VSYNC), fps(60), scale(1), fullscreen(false),
+          pack_path("resources.pak") { }
+};
+
+// Fills options from the command line. Prints usage and returns false on
+// unknown or incomplete options.
+bool parse_options(int argc, char *argv[], Options* options);
+
+#endif  // SRC_OPTIONS_H_
@@ -0,0 +1,110 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/particle_system.h"
+
+#include <cmath>
+
+#include "src/profiler.h"
+#include "src/sprite_batch.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const float GRAVITY = 900.0f;  // Pixels per second squared.
+    const float TWO_PI = 6.2831853f;
+}
+
+ParticleSystem::ParticleSystem()
+    : x(CAPACITY), y(CAPACITY), vx(CAPACITY), vy(CAPACITY),
+      life(CAPACITY), decay(CAPACITY), color(CAPACITY), count(0),
+      vertices(4*CAPACITY), rng(0x9e3779b9u) {
+    indices.reserve(6*CAPACITY);
+    extend_quad_indices(&indices, CAPACITY);
+}
+
+float ParticleSystem::random() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleSystem::burst(const SDL_Rect& area, int n, SDL_Color c,
+        float speed, float lifetime) {
+    for (int k = 0; k < n && count < CAPACITY; k++, count++) {
+        float angle = random()*TWO_PI;
+        float v = speed*(0.25f + 0.75f*random());
+        x[count] = area.x + random()*area.w;
+        y[count] = area.y + random()*area.h;
+        vx[count] = v*std::cos(angle);
+        vy[count] = v*std::sin(angle) - 0.5f*speed;  // Mostly upwards.
+        life[count] = 1.0f;
+        decay[count] = 1.0f / (lifetime*(0.5f + random()));
+        color[count] = c;
+    }
+}
+
+void ParticleSystem::update(float dt) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 fall = _mm_set1_ps(GRAVITY*dt);
+    for (; i + 4 <= count; i += 4) {
+        __m128 pvx = _mm_loadu_ps(&vx[i]);
+        __m128 pvy = _mm_add_ps(_mm_loadu_ps(&vy[i]), fall);
+        _mm_storeu_ps(&x[i],
+                _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(pvx, step)));
+        _mm_storeu_ps(&y[i],
+                _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(pvy, step)));
+        _mm_storeu_ps(&vy[i], pvy);
+        _mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]),
+                    _mm_mul_ps(_mm_loadu_ps(&decay[i]), step)));
+    }
+#endif
+    for (; i < count; i++) {
+        vy[i] += GRAVITY*dt;
+        x[i] += vx[i]*dt;
+        y[i] += vy[i]*dt;
+        life[i] -= decay[i]*dt;
+    }
+
+    // Remove dead particles by moving the last one into their slot.
+    for (i = 0; i < count; ) {
+        if (life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        count--;
+        x[i] = x[count];
+        y[i] = y[count];
+        vx[i] = vx[count];
+        vy[i] = vy[count];
+        life[i] = life[count];
+        decay[i] = decay[count];
+        color[i] = color[count];
+    }
+}
+
+void ParticleSystem::render(SDL_Renderer* renderer, float size) {
+    if (count == 0)
+        return;
+
+    for (int i = 0; i < count; i++) {
+        SDL_Color c = color[i];
+        c.a = static_cast<Uint8>(255.0f*life[i]);
+        SDL_Vertex* quad = &vertices[4*i];
+        quad[0].position = { x[i], y[i] };
+        quad[1].position = { x[i] + size, y[i] };
+        quad[2].position = { x[i], y[i] + size };
+        quad[3].position = { x[i] + size, y[i] + size };
+        for (int k = 0; k < 4; k++)
+            quad[k].color = c;
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(renderer, nullptr, &vertices[0], 4*count,
+            &indices[0], 6*count);
+    FrameProfiler::count_draw_calls();
+}
@@ -0,0 +1,52 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_PARTICLE_SYSTEM_H_
+#define SRC_PARTICLE_SYSTEM_H_
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Short-lived colored squares for line clear and lock effects. Particles
+// live in a fixed pool of parallel arrays, allocated once: emitting never
+// allocates, and particles beyond CAPACITY are dropped. Positions are
+// integrated four at a time with SSE2 and all particles are drawn with a
+// single SDL_RenderGeometry call.
+class ParticleSystem {
+ public:
+    static const int CAPACITY = 8192;
+
+    ParticleSystem();
+
+    // Emits n particles from random points of area, flying out at up
+    // to speed pixels per second and fading out after about lifetime
+    // seconds.
+    void burst(const SDL_Rect& area, int n, SDL_Color color,
+            float speed, float lifetime);
+
+    // Advances every particle by dt seconds and drops the dead ones.
+    void update(float dt);
+
+    // Draws particles as size x size squares, alpha-blended.
+    void render(SDL_Renderer* renderer, float size);
+
+    void clear() { count = 0; }
+    int size() const { return count; }
+
+ private:
+    float random();  // In [0, 1).
+
+    // One entry per particle, the first count are alive. life goes from 1
+    // down to 0 at decay per second and sets the alpha.
+    std::vector<float> x, y, vx, vy, life, decay;
+    std::vector<SDL_Color> color;
+    int count;
+
+    std::vector<SDL_Vertex> vertices;  // 4 per particle.
+    std::vector<int> indices;  // 6 per particle, built once.
+
+    uint32_t rng;  // xorshift32 state.
+};
+
+#endif  // SRC_PARTICLE_SYSTEM_H_
@@ -0,0 +1,44 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/play_frame.h"
+
+#include <cstring>
+
+#include "src/board_batch.h"
+#include "src/tetromino.h"
+
+void make_frame(const BoardBatch& batch, int game, PlayFrame* frame) {
+    for (int i = 0; i < Board::ROWS; i++)
+        for (int j = 0; j < Board::COLS; j++)
+            frame->color[i][j] = batch.color(game, i, j);
+
+    int type = batch.type[game];
+    int rot = batch.rotation[game];
+    int x = batch.x[game];
+    int y = batch.y[game];
+    int landing = y;
+    while (!batch.collides(game, type, rot, x, landing + 1))
+        landing++;
+
+    int coords[4][2];
+    Tetromino::rotated_coords(type, rot, coords);
+    frame->type = type;
+    for (int i = 0; i < Tetromino::SIZE; i++) {
+        frame->block_x[i] = x + coords[i][0];
+        frame->block_y[i] = y + coords[i][1];
+        frame->shadow_y[i] = landing + coords[i][1];
+    }
+
+    Tetromino::rotated_coords(batch.next_type[game], 0, coords);
+    frame->next_type = batch.next_type[game];
+    for (int i = 0; i < Tetromino::SIZE; i++) {
+        frame->next_x[i] = PlayLayout::NEXT_COL + coords[i][0];
+        frame->next_y[i] = PlayLayout::NEXT_ROW + coords[i][1];
+    }
+
+    frame->score = batch.score[game];
+    frame->paused = false;
+    frame->game_over = batch.game_over[game] != 0;
+    frame->show_cursor = true;
+    std::memset(&frame->effects, 0, sizeof(frame->effects));
+}
@@ -0,0 +1,79 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_PLAY_FRAME_H_
+#define SRC_PLAY_FRAME_H_
+
+#include <stdint.h>
+
+#include "src/board.h"
+
+class BoardBatch;
+
+// Where PlayState puts everything in its 500x640 window, in pixels unless
+// noted. make_frame and SoftwareRenderer follow it too, so that golden
+// images track PlayState.
+struct PlayLayout {
+    static const int WIDTH = 500;
+    static const int HEIGHT = 640;
+
+    // Space between board border and window border.
+    static const int GAME_OFFSET = 20;
+
+    // Title, score and "Pause", right of the board.
+    static const int TEXT_X = (Board::COLS + 2)*Board::BLOCK_WIDTH;
+    static const int TEXT_Y = GAME_OFFSET;
+
+    // Next tetromino, in cells from the window's corner.
+    static const int NEXT_COL = Board::COLS + 5;
+    static const int NEXT_ROW = 3*Board::ROWS/10;
+
+    // "New game" button, with "Quit" below it.
+    static const int BUTTON_X = GAME_OFFSET + Board::WIDTH +
+        Board::BLOCK_WIDTH;
+    static const int BUTTON_WIDTH = 7*Board::BLOCK_WIDTH;
+    static const int BUTTON_HEIGHT = 2*Board::BLOCK_HEIGHT;
+    static const int NEWGAME_Y = Board::HEIGHT - 6*Board::BLOCK_HEIGHT;
+    static const int QUIT_Y = NEWGAME_Y + 4*Board::BLOCK_HEIGHT;
+    static const int LABEL_OFFSET = 10;  // Of the button labels.
+
+    // "Game over!".
+    static const int GAME_OVER_Y = HEIGHT - (NEWGAME_Y + BUTTON_HEIGHT) +
+        4*Board::BLOCK_WIDTH;
+};
+
+// Latest line clear and piece lock of a game, for effects. Both are
+// numbered from the start of the game, so a renderer that skips frames
+// still notices the latest of each.
+struct PlayEffects {
+    uint32_t clears;  // Number of line clears so far.
+    int cleared_count;  // Rows removed by the latest one.
+    Board::ClearedRow cleared[Board::MAX_CLEARED];
+    uint32_t locks;  // Number of pieces locked so far.
+    int lock_type;  // Latest locked piece.
+    int lock_x[4];
+    int lock_y[4];
+};
+
+// Everything PlayState::render draws, copied out of the game objects so
+// that frames can be drawn on another thread (PlayState) or without SDL
+// rendering at all (SoftwareRenderer). Block coordinates are in cells.
+struct PlayFrame {
+    int color[Board::ROWS][Board::COLS];
+    int type;  // Falling tetromino.
+    int block_x[4];
+    int block_y[4];
+    int shadow_y[4];  // Where its blocks would land.
+    int next_type;  // Next tetromino, drawn outside of the board.
+    int next_x[4];
+    int next_y[4];
+    int score;
+    bool paused;
+    bool game_over;
+    bool show_cursor;
+    PlayEffects effects;
+};
+
+// Fills frame from one game of a batch, laid out like PlayState.
+void make_frame(const BoardBatch& batch, int game, PlayFrame* frame);
+
+#endif  // SRC_PLAY_FRAME_H_
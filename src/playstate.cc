@@ -7,10 +7,13 @@
 #include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <cstring>
 
 #include "src/game_engine.h"
+#include "src/movegen.h"
 #include "src/tetromino.h"
 #include "src/board.h"
+#include "src/board_texture.h"
 #include "src/utilities.h"
 
 // This will prevent linker errors in case the same names are used
@@ -18,48 +21,103 @@
 namespace {
     std::random_device rd;
     std::mt19937 gen(rd());
+
+    // Color of tetromino type k, as drawn by BoardTexture.
+    SDL_Color block_color(int k) {
+        Uint32 argb = BoardTexture::PALETTE[k + 1];
+        return SDL_Color{ static_cast<Uint8>(argb >> 16),
+            static_cast<Uint8>(argb >> 8), static_cast<Uint8>(argb), 255 };
+    }
 }
 
 PlayState PlayState::m_playstate;
 
-void PlayState::init(GameEngine* game) {
+bool PlayState::load(GameEngine* game) {
+    profiler = &game->profiler;
+    board_layer = nullptr;
+    text_small = nullptr;
+    text_large = nullptr;
+
+    // Music, decoded once and kept by the asset cache. The game is played
+    // silently without it.
+    music_engine = game->assets.sound_engine();
+    music = music_engine != nullptr ?
+        game->assets.sound("resources/sounds/Dubmood-Tetris.ogg") : nullptr;
+
+    // Textures.
+    atlas = game->assets.sprites("resources/sprites/atlas.txt",
+            game->renderer);
+    if (atlas == nullptr)
+        return false;
+    for (int i = 0; i < NCOLORS; i++) {
+        int id;
+        if (!atlas->require("block" + std::to_string(i), &id))
+            return false;
+        block_uv[i] = atlas->uv(id);
+    }
+    white_uv = atlas->uv(atlas->white());
+    board_layer = SDL_CreateTexture(game->renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_TARGET, Board::WIDTH, Board::HEIGHT);
+    SDL_SetTextureBlendMode(board_layer, SDL_BLENDMODE_BLEND);
+
+    // Fonts. Glyphs are rasterized once, text is drawn from the atlases.
+    text_small = game->assets.glyphs("resources/fonts/bitwise.ttf", 16,
+            game->renderer);
+    text_large = game->assets.glyphs("resources/fonts/bitwise.ttf", 20,
+            game->renderer);
+    if (text_small == nullptr || text_large == nullptr)
+        return false;
+
+    // Buttons coordinates.
+    newgamex1       = PlayLayout::BUTTON_X;
+    newgamex2       = PlayLayout::BUTTON_X+PlayLayout::BUTTON_WIDTH;
+    newgamey1       = PlayLayout::NEWGAME_Y+PlayLayout::BUTTON_HEIGHT;
+    newgamey2       = PlayLayout::NEWGAME_Y;
+
+    // Determinism checks, one stream for every game of the session.
+    tick = 0;
+    if (!game->options.checksum_path.empty() &&
+            !checksums.open(game->options.checksum_path))
+        std::cerr << "cannot write checksums to "
+            << game->options.checksum_path << std::endl;
+    return true;
+}
+
+void PlayState::unload(GameEngine* game) {
+    // The device and the assets stay in the cache.
+    game->assets.release(music);
+    game->assets.release(music_engine);
+
+    checksums.close();
+
+    game->assets.release(text_small);
+    game->assets.release(text_large);
+
+    if (board_layer != nullptr)
+        SDL_DestroyTexture(board_layer);
+    game->assets.release(atlas);
+}
+
+// Starts a new game.
+void PlayState::enter(GameEngine* game) {
     // Game objects.
     board        = new Board();
     tetro        = new Tetromino(rand()%7);       // Current tetromino.
     next_tetro   = new Tetromino(rand()%7);       // Next tetromino.
 
-    // Music.
-    music_engine = irrklang::createIrrKlangDevice();
-    music_engine->play2D("resources/sounds/Dubmood-Tetris.ogg", true);
-
-    // Texture.
-    block_texture = load_texture("resources/sprites/block.bmp", game->renderer);
-
-    // Fonts.
-    TTF_Init();
-    white = { 255, 255, 255 };
-    font_pause = TTF_OpenFont("resources/fonts/bitwise.ttf", 16);
-    font_tetris = TTF_OpenFont("resources/fonts/bitwise.ttf", 16);
-    font_score_text = TTF_OpenFont("resources/fonts/bitwise.ttf", 20);
-    font_score = TTF_OpenFont("resources/fonts/bitwise.ttf", 20);
-    font_new_game = TTF_OpenFont("resources/fonts/bitwise.ttf", 20);
-    font_quit = TTF_OpenFont("resources/fonts/bitwise.ttf", 20);
-    font_game_over = TTF_OpenFont("resources/fonts/bitwise.ttf", 16);
-
-    font_image_pause = render_text("Pause",
-            white, font_pause, game->renderer);
-    font_image_tetris = render_text("Tetris Unleashed!",
-            white, font_tetris, game->renderer);
-    font_image_score_text = render_text("Score: ",
-            white, font_score_text, game->renderer);
-    font_image_score = render_text(std::to_string(board->get_score()),
-        white, font_score, game->renderer);
-    font_image_new_game = render_text("New game",
-            white, font_new_game, game->renderer);
-    font_image_quit = render_text("Quit",
-            white, font_quit, game->renderer);
-    font_image_game_over = render_text("Game over!",
-            white, font_game_over, game->renderer);
+    if (music != nullptr)
+        music_engine->play2D(music, true);
+
+    // The layer still shows the previous game.
+    layer_lost = true;
+    cursor_shown = true;
+
+    // Effects.
+    std::memset(&effects, 0, sizeof(effects));
+    shown_clears = 0;
+    shown_locks = 0;
+    particles.clear();
+    particle_time = SDL_GetTicks();
 
     // Frame rate.
     acceleration    = 0.015f;
@@ -74,15 +132,11 @@ void PlayState::init(GameEngine* game) {
     quitdown        = false;
     quitup          = false;
 
-    // Buttons coordinates.
-    newgamex1       = GAME_OFFSET+board->WIDTH+board->BLOCK_WIDTH;
-    newgamex2       = GAME_OFFSET+board->WIDTH+8*board->BLOCK_WIDTH;
-    newgamey1       = board->HEIGHT-4*board->BLOCK_HEIGHT;
-    newgamey2       = board->HEIGHT-6*board->BLOCK_HEIGHT;
-
     paused          = false;
     game_over       = false;
-    exit            = false;
+    quitting        = false;
+    to_menu         = false;
+    show_cursor     = true;
 
     // At the start of the game:
     // x position of (0, 0) block of tetro is int(15/2) = 7
@@ -92,49 +146,39 @@ void PlayState::init(GameEngine* game) {
 
     // Position next_tetro at the upper right of the window,
     // outside of the board.
-    next_tetro->set_position(board->COLS+5, static_cast<int>(0.3*board->ROWS));
+    next_tetro->set_position(PlayLayout::NEXT_COL, PlayLayout::NEXT_ROW);
     int newx;
     int rotnum;
     check_all(newx,rotnum);
     tetro->rotate_right_multiple(rotnum);
     tetro->set_position(newx,tetro->y);
     tetro->speed_up = true;
+
+    publish_frame();
 }
 
-void PlayState::clean_up(GameEngine* game) {
-    // Delete music engine.
-    music_engine->drop();
-
-    TTF_CloseFont(font_pause);
-    TTF_CloseFont(font_tetris);
-    TTF_CloseFont(font_score_text);
-    TTF_CloseFont(font_score);
-    TTF_CloseFont(font_new_game);
-    TTF_CloseFont(font_quit);
-    TTF_CloseFont(font_game_over);
-
-    SDL_DestroyTexture(font_image_pause);
-    SDL_DestroyTexture(font_image_tetris);
-    SDL_DestroyTexture(font_image_score_text);
-    SDL_DestroyTexture(font_image_score);
-    SDL_DestroyTexture(font_image_new_game);
-    SDL_DestroyTexture(font_image_quit);
-    SDL_DestroyTexture(font_image_game_over);
-
-    IMG_Quit();
-
-    SDL_DestroyRenderer(game->renderer);
-    SDL_DestroyWindow(game->window);
-    SDL_Quit();
+void PlayState::exit(GameEngine* game) {
+    // Stop the music.
+    if (music_engine != nullptr)
+        music_engine->stopAllSounds();
+
+    delete board;
+    delete tetro;
+    delete next_tetro;
+    board = nullptr;
+    tetro = nullptr;
+    next_tetro = nullptr;
 }
 
 void PlayState::pause() {
-    music_engine->setAllSoundsPaused(true);
+    if (music_engine != nullptr)
+        music_engine->setAllSoundsPaused(true);
     paused = true;
 }
 
 void PlayState::resume() {
-    music_engine->setAllSoundsPaused(false);
+    if (music_engine != nullptr)
+        music_engine->setAllSoundsPaused(false);
     paused = false;
 }
 
@@ -158,11 +202,13 @@ void PlayState::reset() {
     tetro = new Tetromino(rand()%7);
     next_tetro = new Tetromino(rand()%7);
     tetro->set_position(static_cast<int>(board->COLS/2), 0);
-    next_tetro->set_position(board->COLS+5, static_cast<int>(0.3*board->ROWS));
+    next_tetro->set_position(PlayLayout::NEXT_COL, PlayLayout::NEXT_ROW);
 
     // Restart music.
-    music_engine->stopAllSounds();
-    music_engine->play2D("resources/sounds/Dubmood-Tetris.ogg", true);
+    if (music != nullptr) {
+        music_engine->stopAllSounds();
+        music_engine->play2D(music, true);
+    }
 
     game_over       = false;
     newgameup       = false;
@@ -182,122 +228,131 @@ void PlayState::reset() {
 void PlayState::input(GameEngine *game) {
     // Queuing events.
     SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        // Clicking 'x' or pressing F4.
-        if (event.type == SDL_QUIT) {
-            exit = true;
-        }
+    while (SDL_PollEvent(&event))
+        handle_event(game, event);
+}
 
-        // Key is pressed.
-        if (event.type == SDL_KEYDOWN) {
-            // Pause/Resume.
-            if (event.key.keysym.sym == SDLK_p) {
-                if (paused) {
-                    resume();
-                } else {
-                    pause();
-                }
-            }
+void PlayState::handle_event(GameEngine* game, const SDL_Event& event) {
+    // Clicking 'x' or pressing F4.
+    if (event.type == SDL_QUIT) {
+        quitting = true;
+    }
 
-            if (!paused && !tetro->free_fall) {
-                switch (event.key.keysym.sym) {
-                    case SDLK_ESCAPE:
-                        exit = true;
-                        break;
-                    case SDLK_a: case SDLK_LEFT:
-                        tetro->movement = tetro->LEFT;
-                        tetro->shift = true;
-                        break;
-                    case SDLK_d: case SDLK_RIGHT:
-                        tetro->movement = tetro->RIGHT;
-                        tetro->shift = true;
-                        break;
-                    case SDLK_w: case SDLK_UP:
-                        if (tetro->type != 2)  // type 3 is O-Block.
-                            tetro->rotate = true;
-                        break;
-                    case SDLK_s: case SDLK_DOWN:
-                        tetro->speed_up = true;
-                        break;
-                    case SDLK_SPACE:
-                        tetro->free_fall = true;
-                        break;
-                    default:
-                        break;
-                }
+    // Render target contents were lost, redraw the board layer.
+    if (event.type == SDL_RENDER_TARGETS_RESET ||
+            event.type == SDL_RENDER_DEVICE_RESET) {
+        layer_lost = true;
+    }
+
+    // Key is pressed.
+    if (event.type == SDL_KEYDOWN) {
+        // Pause/Resume.
+        if (event.key.keysym.sym == SDLK_p) {
+            if (paused) {
+                resume();
+            } else {
+                pause();
             }
         }
 
-        // Key is released.
-        if (event.type == SDL_KEYUP) {
+        if (!paused && !tetro->free_fall) {
             switch (event.key.keysym.sym) {
+                case SDLK_ESCAPE:
+                    to_menu = true;
+                    break;
+                case SDLK_a: case SDLK_LEFT:
+                    tetro->movement = tetro->LEFT;
+                    tetro->shift = true;
+                    break;
+                case SDLK_d: case SDLK_RIGHT:
+                    tetro->movement = tetro->RIGHT;
+                    tetro->shift = true;
+                    break;
+                case SDLK_w: case SDLK_UP:
+                    if (tetro->type != 2)  // type 3 is O-Block.
+                        tetro->rotate = true;
+                    break;
                 case SDLK_s: case SDLK_DOWN:
-                    tetro->speed_up = false;
+                    tetro->speed_up = true;
+                    break;
+                case SDLK_SPACE:
+                    tetro->free_fall = true;
                     break;
                 default:
                     break;
             }
         }
+    }
 
-        // Mouse moves.
-        if (event.type == SDL_MOUSEMOTION) {
-            // Outside of the board.
-            if (event.motion.x > board->WIDTH + GAME_OFFSET)
-                SDL_ShowCursor(1);  // Show cursor.
-
-            // Inside the board.
-            else
-                SDL_ShowCursor(0);  // Don't show cursor.
+    // Key is released.
+    if (event.type == SDL_KEYUP) {
+        switch (event.key.keysym.sym) {
+            case SDLK_s: case SDLK_DOWN:
+                tetro->speed_up = false;
+                break;
+            default:
+                break;
         }
+    }
 
-        // Mouse button clicked.
-        if (event.type == SDL_MOUSEBUTTONDOWN) {
-            switch (event.button.button) {
-                // Left mouse button clicked.
-                case SDL_BUTTON_LEFT: {
-                    int x = event.button.x;
-                    int y = event.button.y;
-                    if (x > newgamex1 &&
-                        x < newgamex2) {
-                        // And mouse cursor is on "New Game" button.
-                        if (y > newgamey2 &&
-                            y < newgamey1) {
-                            newgamedown = true;
-                        // And mouse cursor is on "Quit" button.
-                        } else if (y > newgamey2+4*board->BLOCK_HEIGHT &&
-                                   y < newgamey1+4*board->BLOCK_HEIGHT) {
-                            quitdown = true;
-                        }
+    // Mouse moves.
+    if (event.type == SDL_MOUSEMOTION) {
+        // Outside of the board.
+        if (event.motion.x > board->WIDTH + GAME_OFFSET)
+            show_cursor = true;  // Show cursor.
+
+        // Inside the board.
+        else
+            show_cursor = false;  // Don't show cursor.
+    }
+
+    // Mouse button clicked.
+    if (event.type == SDL_MOUSEBUTTONDOWN) {
+        switch (event.button.button) {
+            // Left mouse button clicked.
+            case SDL_BUTTON_LEFT: {
+                int x = event.button.x;
+                int y = event.button.y;
+                if (x > newgamex1 &&
+                    x < newgamex2) {
+                    // And mouse cursor is on "New Game" button.
+                    if (y > newgamey2 &&
+                        y < newgamey1) {
+                        newgamedown = true;
+                    // And mouse cursor is on "Quit" button.
+                    } else if (y > newgamey2+4*board->BLOCK_HEIGHT &&
+                               y < newgamey1+4*board->BLOCK_HEIGHT) {
+                        quitdown = true;
                     }
-                    break;
                 }
-                default:
-                    break;
+                break;
             }
+            default:
+                break;
         }
+    }
 
-        // Mouse button released.
-        if (event.type == SDL_MOUSEBUTTONUP) {
-            switch (event.button.button) {
-                // Left mouse button released.
-                case SDL_BUTTON_LEFT: {
-                    int x = event.button.x;
-                    int y = event.button.y;
-                    if (x > newgamex1 && x < newgamex2) {
-                        // And mouse cursor is on "New Game" button.
-                        if (y > newgamey2 && y < newgamey1) {
-                            newgameup = true;
-                        // And mouse cursor is on "Quit" button.
-                        } else if (y > newgamey2+4*board->BLOCK_HEIGHT &&
-                                 y < newgamey1+4*board->BLOCK_HEIGHT) {
-                            quitup = true;
-                        }
+    // Mouse button released.
+    if (event.type == SDL_MOUSEBUTTONUP) {
+        switch (event.button.button) {
+            // Left mouse button released.
+            case SDL_BUTTON_LEFT: {
+                int x = event.button.x;
+                int y = event.button.y;
+                if (x > newgamex1 && x < newgamex2) {
+                    // And mouse cursor is on "New Game" button.
+                    if (y > newgamey2 && y < newgamey1) {
+                        newgameup = true;
+                    // And mouse cursor is on "Quit" button.
+                    } else if (y > newgamey2+4*board->BLOCK_HEIGHT &&
+                             y < newgamey1+4*board->BLOCK_HEIGHT) {
+                        quitup = true;
                     }
-                    break;
                 }
-                default:
-                    break;
+                break;
             }
+            default:
+                break;
         }
     }
 }
@@ -335,7 +390,6 @@ int PlayState::count_pits(int length){
             count++;
         max_len = 0;
     }
-    std::cerr << "COUNT IS " << count << std::endl;
     return count;
 }
 
@@ -370,41 +424,12 @@ int PlayState::cost(){
     return cost;
 }
 
-bool proceed;
-bool PlayState::checkInBounds(){
-    for (int k = 0; k < 4; k++){
-        if (test_tetro->coords[k][0] + test_tetro->x < 0){
-            //test_tetro->x++;
-            std::cerr << "X IS TOO LOW\n" << std::endl;
-            proceed = false;
-            return false;
-        }                                                                     
-        if (test_tetro->coords[k][0] + test_tetro->x > ending_bound){
-            //test_tetro->x--;
-            std::cerr << "X IS TOO HIGH\n" << std::endl;
-            proceed = false;
-            return false;
-        }
-    }
-    for (int k = 0; k < 4; k++){
-        if (test_tetro->coords[k][1] + test_tetro->y > 29){
-            return false;
-        }
-    }
-    return true;
-}
-
-bool PlayState::checkCollision(){
-    for (int k = 0; k < 4; k++){
-        if (test_board[test_tetro->coords[k][1] + test_tetro->y][test_tetro->coords[k][0] + test_tetro->x] != -1)
-            return false;
-    }
-    return true;
-}
-
-int initial;
+// Scores every placement the move generator finds for the current
+// tetromino (the generator perft counts) and picks the cheapest, lowest
+// column first on ties. Columns right of ending_bound are kept as a well
+// for the I-Block; they are only used when nothing else fits.
 void PlayState::check_all(int& x_val, int& num_rot){
-    std::cerr << "before new tetromino\n" << std::endl;
+    FrameProfiler::Scope scope(profiler, FrameProfiler::AI);
     bool filled = true;
     if(tetro->type == 5){
         for(int i = 0; i < 14;i++){
@@ -426,71 +451,43 @@ void PlayState::check_all(int& x_val, int& num_rot){
         num_rot = 0;
         return;
     }
-    test_tetro = new Tetromino(tetro->type);
-    initial = 3;
-    //int total_rotations;
-
-
-    int rot = 0;
-    std::vector<std::vector<std::pair<int, int>>> costs;
-    std::cerr << "before rotating\n" << std::endl;
-    //get cost vectors for each rotation
-    for (; rot < 4; rot++){
-        std::cerr << "rotation is " << rot << std::endl;
-        costs.push_back(check_all_xpos());
-        test_tetro->rotate_right();
-    }
-    std::vector<std::pair<std::pair<int, int>, int>> mins; //holds minimium costs for each rotation
-    std::pair<std::pair<int, int>, int> temp; //to insert elements into mins
-    //insert minimums into vector, along with indices
-    for (int k = 0; k < 4; k++){
-        temp.first = *min_element(costs[k].begin(), costs[k].end()); 
-        temp.second = k;
-        mins.push_back(temp);
-    }
-    //determine minimums
-    x_val = min_element(mins.begin(), mins.end())->first.second;
-    num_rot =  min_element(mins.begin(), mins.end())->second;
-    int cost = min_element(mins.begin(), mins.end())->first.first;
-    delete(test_tetro);
-    std::cerr << "x_val is " << x_val << ", num_rot is " << num_rot << ", and cost is " << cost << std::endl;
-}
 
-std::vector<std::pair<int, int>> PlayState::check_all_xpos(){
-    int curx = 0;
-    std::cerr << "left is " << tetro->left << std::endl;
-    int stop = board->COLS - tetro->width; //Change back if tetris formula doesn't work
-    std::vector<std::pair<int, int>> costs;
-
-    std::pair<int, int> cost_pos;
-    for (int k = 0; k < stop; k++){
-        test_tetro->x = curx;
-        test_tetro->y = initial;
-
-        copyColor();
-        test_tetro->update_width();
-        proceed = true;
-        while (checkInBounds() && checkCollision()){
-            (test_tetro->y)++;
-        }
-        (test_tetro->y)--;
-        //test_tetro->y = 27;
-        if (proceed){
-            for (int k = 0; k < 4; k++){
-                std::cerr << "(" << test_tetro->coords[k][0] + test_tetro->x << ", " << test_tetro->coords[k][1] + test_tetro->y << ")" << std::endl;
-                test_board[test_tetro->coords[k][1] + test_tetro->y][test_tetro->coords[k][0] + test_tetro->x] = 1;
+    Placement placements[MAX_PLACEMENTS];
+    int n = generate_placements(*board, tetro->type, placements);
+    x_val = tetro->x;
+    num_rot = 0;
+    int best = -1;
+    int best_cost = 0;
+    for (int pass = 0; pass < 2 && best < 0; pass++) {
+        int bound = pass == 0 ? ending_bound : board->COLS - 1;
+        for (int i = 0; i < n; i++) {
+            const Placement& placement = placements[i];
+            int coords[Tetromino::SIZE][2];
+            Tetromino::rotated_coords(tetro->type, placement.rot, coords);
+
+            bool in_bounds = true;
+            for (int k = 0; k < Tetromino::SIZE; k++)
+                if (placement.x + coords[k][0] > bound)
+                    in_bounds = false;
+            if (!in_bounds)
+                continue;
+
+            copyColor();
+            for (int k = 0; k < Tetromino::SIZE; k++) {
+                int y = placement.y + coords[k][1];
+                if (y >= 0)
+                    test_board[y][placement.x + coords[k][0]] = 1;
+            }
+            int c = cost();
+            if (best < 0 || c < best_cost ||
+                    (c == best_cost && placement.x < x_val)) {
+                best = i;
+                best_cost = c;
+                x_val = placement.x;
+                num_rot = placement.rot;
             }
-            //std::cerr << "x is " << curx << " and y is " << test_tetro->y << std::endl;
-            cost_pos.first = cost(); 
-            std::cerr << "cost is " << cost() << std::endl;
-            cost_pos.second = curx;
-            costs.push_back(cost_pos);
         }
-        curx++;
-
-        test_tetro->y = initial;
     }
-    return costs;
 }
 
 
@@ -513,18 +510,28 @@ void PlayState::release_tetromino() {
     tetro->speed_up = true;
 }
 
-// Update game values.
 void PlayState::update(GameEngine* game) {
+    step(game);
+    publish_frame();
+}
+
+// Update game values.
+void PlayState::step(GameEngine* game) {
     // New Game button was pressed.
     if (newgameup && newgamedown) {
         reset();
     }
 
     // Quit button or 'x'/F4 was pressed.
-    if ((quitup && quitdown) || exit) {
+    if ((quitup && quitdown) || quitting) {
         game->quit();
     }
 
+    // Escape was pressed.
+    if (to_menu) {
+        game->pop_state();
+    }
+
     if (game_over || paused) {
         return;
     }
@@ -537,8 +544,15 @@ void PlayState::update(GameEngine* game) {
         // has crossed over the top border.
         if (!board->add(tetro)) {
             game_over = true;
+            record_checksum();
             return;
         }
+        effects.locks++;
+        effects.lock_type = tetro->type;
+        for (int i = 0; i < tetro->SIZE; i++) {
+            effects.lock_x[i] = tetro->get_block_x(i);
+            effects.lock_y[i] = tetro->get_block_y(i);
+        }
 
         // Drop stored tetromino and replace by newly-generated tetromino.
         release_tetromino();
@@ -619,168 +633,273 @@ void PlayState::update(GameEngine* game) {
         }
     }
     board->delete_full_rows();
+    if (board->cleared_count > 0) {
+        effects.clears++;
+        effects.cleared_count = board->cleared_count;
+        std::memcpy(effects.cleared, board->cleared, sizeof(effects.cleared));
+    }
     tetro->rotate = false;
     tetro->shift = false;
     tetro->movement = tetro->NONE;
+
+    record_checksum();
+}
+
+// Append the state reached by this update to the checksum stream.
+void PlayState::record_checksum() {
+    tick++;
+    if (!checksums.is_open())
+        return;
+
+    TickChecksum checksum;
+    checksum.tick = tick;
+    checksum.board = board->hash();
+    checksum.piece = tetro->hash();
+    checksum.score = board->get_score();
+    checksums.record(checksum);
+}
+
+// Nothing moves while paused or after the game is lost, once the last
+// particles are gone. Read from the last frame, which is what the main
+// thread sees in the threaded mode.
+bool PlayState::idle() {
+    const PlayFrame& frame = frames.read_buffer();
+    return (frame.paused || frame.game_over) && particles.size() == 0;
+}
+
+// Copy what render() needs into the next frame and hand it over.
+void PlayState::publish_frame() {
+    PlayFrame& frame = frames.write_buffer();
+    std::memcpy(frame.color, board->color, sizeof(frame.color));
+
+    frame.type = tetro->type;
+    for (int i = 0; i < tetro->SIZE; i++) {
+        frame.block_x[i] = tetro->get_block_x(i);
+        frame.block_y[i] = tetro->get_block_y(i);
+    }
+    tetro->get_shadow(board, frame.shadow_y);
+
+    frame.next_type = next_tetro->type;
+    for (int i = 0; i < next_tetro->SIZE; i++) {
+        frame.next_x[i] = next_tetro->get_block_x(i);
+        frame.next_y[i] = next_tetro->get_block_y(i);
+    }
+
+    frame.score = board->get_score();
+    frame.paused = paused;
+    frame.game_over = game_over;
+    frame.show_cursor = show_cursor;
+    frame.effects = effects;
+    frames.publish();
 }
 
 // Render result.
 void PlayState::render(GameEngine* game) {
+    frames.update();
+    const PlayFrame& frame = frames.read_buffer();
+
+    if (frame.show_cursor != cursor_shown) {
+        SDL_ShowCursor(frame.show_cursor);
+        cursor_shown = frame.show_cursor;
+    }
+
     // Clear screen.
     SDL_SetRenderDrawColor(game->renderer, 0, 0, 0, 1);
     SDL_RenderClear(game->renderer);
 
-    // Render "Tetris" text.
-    int x = (next_tetro->x-3)*board->BLOCK_WIDTH;
-    int y = GAME_OFFSET;
+    // Text is queued per font and drawn on top of everything at the end.
+    small_batch.begin(text_small->get_texture());
+    large_batch.begin(text_large->get_texture());
+
+    // Render "Tetris" text, left of the next tetromino.
+    int x = PlayLayout::TEXT_X;
+    int y = PlayLayout::TEXT_Y;
 
-    render_texture(font_image_tetris, game->renderer, x, y);
+    text_small->draw(&small_batch, "Tetris Unleashed!", x, y);
 
     // Render "Pause" text if game is paused.
-    if (paused)
-        render_texture(font_image_pause, game->renderer, x, y+40);
+    if (frame.paused)
+        text_small->draw(&small_batch, "Pause", x, y+40);
 
     // Render score text.
-    render_texture(font_image_score_text,
-            game->renderer, x, y + board->BLOCK_WIDTH);
+    text_large->draw(&large_batch, "Score: ", x, y + Board::BLOCK_WIDTH);
 
     // Render score.
-    if (board->render_score) {
-        font_image_score = render_text(std::to_string(board->get_score()),
-                white, font_score, game->renderer);
-        board->render_score = false;
-    }
-    render_texture(font_image_score,
-            game->renderer, x + 60, y + board->BLOCK_WIDTH);
+    text_large->draw_number(&large_batch, frame.score,
+            x + 60, y + Board::BLOCK_WIDTH);
 
     int tetro_x, tetro_y;
 
-    // Prepare textures.
-    int iW, iH;
-    SDL_QueryTexture(block_texture, nullptr, nullptr, &iW, &iH);
-
-    SDL_Rect clips[7];
-    for (int i = 0; i < 7; i++) {
-        clips[i].x = 0;
-        clips[i].y = i*24;
-        clips[i].w = 20;
-        clips[i].h = 20;
-    }
+    // Moving blocks below are queued and drawn with a single call.
+    sprites.begin(atlas->get_texture());
 
     // Draw tetromino squares.
-    for (int i = 0; i < tetro->SIZE; i++) {
+    for (int i = 0; i < Tetromino::SIZE; i++) {
         // Get new coordinates.
-        tetro_x = tetro->get_block_x(i)*board->BLOCK_WIDTH + GAME_OFFSET;
-        tetro_y = tetro->get_block_y(i)*board->BLOCK_HEIGHT + GAME_OFFSET;
+        tetro_x = frame.block_x[i]*Board::BLOCK_WIDTH + GAME_OFFSET;
+        tetro_y = frame.block_y[i]*Board::BLOCK_HEIGHT + GAME_OFFSET;
 
-        draw_block(game, tetro_x, tetro_y, tetro->type, clips);
+        draw_block(tetro_x, tetro_y, frame.type);
     }
 
     // Draw shadow tetromino.
-    int shadow_y[4];
-    tetro->get_shadow(board, shadow_y);
-    for (int i = 0; i < tetro->SIZE; i++) {
-        if (shadow_y[i] < 0)
+    for (int i = 0; i < Tetromino::SIZE; i++) {
+        if (frame.shadow_y[i] < 0)
             break;
-        int x = tetro->get_block_x(i)*board->BLOCK_WIDTH + GAME_OFFSET;
-        int y = shadow_y[i]*board->BLOCK_WIDTH + GAME_OFFSET;
+        int x = frame.block_x[i]*Board::BLOCK_WIDTH + GAME_OFFSET;
+        int y = frame.shadow_y[i]*Board::BLOCK_WIDTH + GAME_OFFSET;
 
         // Draw block.
-        SDL_SetRenderDrawColor(game->renderer, 180, 180, 180, 255);
-        SDL_Rect shadow_block = {x, y, board->BLOCK_WIDTH, board->BLOCK_HEIGHT};
-        SDL_RenderFillRect(game->renderer, &shadow_block);
+        SDL_Rect shadow_block = {x, y, Board::BLOCK_WIDTH, Board::BLOCK_HEIGHT};
+        sprites.add(white_uv, shadow_block, SDL_Color{180, 180, 180, 255});
     }
 
-    if (!game_over) {
+    if (!frame.game_over) {
         // Draw next tetromino.
-        for (int i = 0; i < next_tetro->SIZE; i++) {
+        for (int i = 0; i < Tetromino::SIZE; i++) {
             // Get new coordinates.
-            tetro_x = next_tetro->get_block_x(i)*board->BLOCK_WIDTH;
-            tetro_y = next_tetro->get_block_y(i)*board->BLOCK_HEIGHT;
+            tetro_x = frame.next_x[i]*Board::BLOCK_WIDTH;
+            tetro_y = frame.next_y[i]*Board::BLOCK_HEIGHT;
 
-            draw_block(game, tetro_x, tetro_y, next_tetro->type, clips);
+            draw_block(tetro_x, tetro_y, frame.next_type);
         }
     }
 
-    // This is the board. Non-active tetrominos live here.
-    for (int i = 0; i < board->ROWS; i++)
-        for (int j = 0; j < board->COLS; j++)
-            if (board->color[i][j] != -1) {
-                // Get new coordinates.
-                tetro_x = j*board->BLOCK_WIDTH + GAME_OFFSET;
-                tetro_y = i*board->BLOCK_HEIGHT + GAME_OFFSET;
-
-                draw_block(game, tetro_x, tetro_y, board->color[i][j], clips);
-            }
-
-    // Box surrounding board.
-
-    // Set color to white.
-    SDL_SetRenderDrawColor(game->renderer, 180, 180, 180, 255);
+    sprites.flush(game->renderer);
 
-    // Draw left border.
-    SDL_RenderDrawLine(game->renderer,
-        GAME_OFFSET, GAME_OFFSET, GAME_OFFSET, GAME_OFFSET+board->HEIGHT);
-
-    // Draw right border.
-    SDL_RenderDrawLine(game->renderer,
-            GAME_OFFSET+board->WIDTH, GAME_OFFSET,
-            GAME_OFFSET+board->WIDTH, GAME_OFFSET+board->HEIGHT);
+    // This is the board. Non-active tetrominos live here.
+    update_board_layer(game, frame);
+    SDL_Rect layer = { GAME_OFFSET, GAME_OFFSET, Board::WIDTH, Board::HEIGHT };
+    SDL_RenderCopy(game->renderer, board_layer, nullptr, &layer);
+    FrameProfiler::count_draw_calls();
 
-    // Draw upper border.
-    SDL_RenderDrawLine(game->renderer,
-            GAME_OFFSET, GAME_OFFSET, GAME_OFFSET+board->WIDTH, GAME_OFFSET);
+    // Line clear and lock effects, above the blocks.
+    update_particles(frame);
+    particles.render(game->renderer, 3.0f);
 
-    // Draw bottom border.
-    SDL_RenderDrawLine(game->renderer,
-            GAME_OFFSET, GAME_OFFSET+board->HEIGHT,
-            GAME_OFFSET+board->WIDTH, GAME_OFFSET+board->HEIGHT);
+    // Box surrounding board, and the buttons, in one call.
+    SDL_Rect box = { GAME_OFFSET, GAME_OFFSET,
+        Board::WIDTH + 1, Board::HEIGHT + 1 };
+    game->primitives.outline(box, SDL_Color{180, 180, 180, 255});
 
     // If game is over, display "Game Over!".
-    if (game_over)
-        render_texture(font_image_game_over,
-                game->renderer, newgamex1,
-                game->height-newgamey1+4*board->BLOCK_WIDTH);
+    if (frame.game_over)
+        text_small->draw(&small_batch, "Game over!", newgamex1,
+                PlayLayout::GAME_OVER_Y);
 
     // Create "New Game" button.
-    int blue[4] = {0, 0, 255, 255};
-    create_button(game, newgamex1, newgamey2,
-            7*board->BLOCK_WIDTH, 2*board->BLOCK_HEIGHT, blue);
+    SDL_Rect newgame = { newgamex1, PlayLayout::NEWGAME_Y,
+        PlayLayout::BUTTON_WIDTH, PlayLayout::BUTTON_HEIGHT };
+    game->primitives.fill(newgame, SDL_Color{0, 0, 255, 255});
 
     // Render "New Game" font.
-    render_texture(font_image_new_game,
-            game->renderer, newgamex1+10, newgamey2+10);
+    text_large->draw(&large_batch, "New game",
+            newgamex1+PlayLayout::LABEL_OFFSET,
+            PlayLayout::NEWGAME_Y+PlayLayout::LABEL_OFFSET);
 
     // Create "Quit" button.
-    int red[4] = {255, 0, 0, 255};
-    create_button(game, newgamex1,
-            newgamey2+4*board->BLOCK_HEIGHT, 7*board->BLOCK_WIDTH,
-            2*board->BLOCK_HEIGHT, red);
+    SDL_Rect quit = { newgamex1, PlayLayout::QUIT_Y,
+        PlayLayout::BUTTON_WIDTH, PlayLayout::BUTTON_HEIGHT };
+    game->primitives.fill(quit, SDL_Color{255, 0, 0, 255});
 
     // Render "Quit" font.
-    render_texture(font_image_quit,
-            game->renderer, newgamex1+10, newgamey2+4*board->BLOCK_HEIGHT+10);
+    text_large->draw(&large_batch, "Quit",
+            newgamex1+PlayLayout::LABEL_OFFSET,
+            PlayLayout::QUIT_Y+PlayLayout::LABEL_OFFSET);
+
+    game->primitives.flush(game->renderer);
+    small_batch.flush(game->renderer);
+    large_batch.flush(game->renderer);
+}
+
+// Redraw the rows of the board layer that differ from frame.
+void PlayState::update_board_layer(GameEngine* game, const PlayFrame& frame) {
+    // Frames may be skipped, so compare with what the layer holds rather
+    // than tracking changes on the simulation side.
+    bool lost = layer_lost.exchange(false);
+    uint32_t dirty_rows = 0;
+    for (int i = 0; i < Board::ROWS; i++)
+        if (lost || std::memcmp(layer_color[i], frame.color[i],
+                    sizeof(layer_color[i])) != 0)
+            dirty_rows |= 1u << i;
+    if (dirty_rows == 0)
+        return;
+    std::memcpy(layer_color, frame.color, sizeof(layer_color));
+
+    SDL_Texture* target = SDL_GetRenderTarget(game->renderer);
+    SDL_SetRenderTarget(game->renderer, board_layer);
+
+    // Erase the dirty rows to transparent and queue their blocks.
+    SDL_Rect erase[Board::ROWS];
+    int erased = 0;
+    sprites.begin(atlas->get_texture());
+    for (int i = 0; i < Board::ROWS; i++) {
+        if (!(dirty_rows & (1u << i)))
+            continue;
+        erase[erased++] = { 0, i*Board::BLOCK_HEIGHT,
+            Board::WIDTH, Board::BLOCK_HEIGHT };
+        for (int j = 0; j < Board::COLS; j++)
+            if (frame.color[i][j] != -1)
+                draw_block(j*Board::BLOCK_WIDTH, i*Board::BLOCK_HEIGHT,
+                        frame.color[i][j]);
+    }
+    SDL_SetRenderDrawBlendMode(game->renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(game->renderer, 0, 0, 0, 0);
+    SDL_RenderFillRects(game->renderer, erase, erased);
+    FrameProfiler::count_draw_calls();
+    sprites.flush(game->renderer);
 
-    // Swap buffers.
-    SDL_RenderPresent(game->renderer);
+    SDL_SetRenderTarget(game->renderer, target);
 }
 
-// Create "New Game" and "Quit" buttons.
-void PlayState::create_button(GameEngine* game,
-        int x, int y, int width, int height, int color[]) {
-    SDL_Rect rect = { x, y, width, height };
-    SDL_SetRenderDrawColor(game->renderer,
-            color[0], color[1], color[2], color[3]);
-    SDL_RenderFillRect(game->renderer, &rect);
+// Spawn effects for the clear and lock events that are new in frame and
+// advance the particles by the time since the previous call.
+void PlayState::update_particles(const PlayFrame& frame) {
+    const PlayEffects& fx = frame.effects;
+    if (fx.clears != shown_clears) {
+        shown_clears = fx.clears;
+        for (int i = 0; i < fx.cleared_count; i++) {
+            const Board::ClearedRow& row = fx.cleared[i];
+            for (int j = 0; j < Board::COLS; j++) {
+                if (row.color[j] == -1)
+                    continue;
+                SDL_Rect cell = { GAME_OFFSET + j*Board::BLOCK_WIDTH,
+                    GAME_OFFSET + row.row*Board::BLOCK_HEIGHT,
+                    Board::BLOCK_WIDTH, Board::BLOCK_HEIGHT };
+                particles.burst(cell, 32, block_color(row.color[j]),
+                        400.0f, 0.8f);
+            }
+        }
+    }
+    if (fx.locks != shown_locks) {
+        shown_locks = fx.locks;
+        for (int i = 0; i < Tetromino::SIZE; i++) {
+            SDL_Rect cell = { GAME_OFFSET + fx.lock_x[i]*Board::BLOCK_WIDTH,
+                GAME_OFFSET + (fx.lock_y[i] + 1)*Board::BLOCK_HEIGHT - 2,
+                Board::BLOCK_WIDTH, 2 };
+            particles.burst(cell, 6, block_color(fx.lock_type), 120.0f, 0.3f);
+        }
+    }
+
+    // Effects follow the wall clock, even with --fixed-step. Long gaps,
+    // e.g. while idle, are cut short.
+    Uint32 now = SDL_GetTicks();
+    float dt = std::min((now - particle_time) / 1000.0f, 0.1f);
+    particle_time = now;
+    particles.update(dt);
 }
 
-// Render Tetromino block.
-void PlayState::draw_block(GameEngine* game,
-        int x, int y, int k, SDL_Rect clips[]) {
-    render_texture(block_texture, game->renderer, x, y, &clips[k]);
+// Queue Tetromino block.
+void PlayState::draw_block(int x, int y, int k) {
+    SDL_Rect dst = { x, y, Board::BLOCK_WIDTH, Board::BLOCK_HEIGHT };
+    sprites.add(block_uv[k], dst);
 }
 
 float PlayState::frame_rate(GameEngine* game, int* last_time, int* this_time) {
+    // Reproducible runs ignore the wall clock.
+    if (game->options.fixed_step)
+        return 1.0f / 60.0f;
+
     // Get number of milliseconds since SDL_Init() of the previous frame.
     *last_time = *this_time;
 
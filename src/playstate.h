@@ -7,22 +7,33 @@
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h>
 #include <irrKlang.h>
+#include <atomic>
 #include <vector>
 
 #include "src/gamestate.h"
+#include "src/board.h"
+#include "src/checksum.h"
+#include "src/particle_system.h"
+#include "src/play_frame.h"
+#include "src/sprite_batch.h"
+#include "src/glyph_atlas.h"
+#include "src/sprite_atlas.h"
+#include "src/triple_buffer.h"
 
 class Tetromino;
-class Board;
 
 class PlayState : public GameState {
  public:
     static const int NCOLORS = 7;
 
     // Space between board border and window border.
-    static const int GAME_OFFSET = 20;
+    static const int GAME_OFFSET = PlayLayout::GAME_OFFSET;
 
-    void init(GameEngine* game);
-    void clean_up(GameEngine* game);
+    bool load(GameEngine* game);
+    void unload(GameEngine* game);
+
+    void enter(GameEngine* game);
+    void exit(GameEngine* game);
 
     void pause();
     void resume();
@@ -32,6 +43,11 @@ class PlayState : public GameState {
     void update(GameEngine* game);
     void render(GameEngine* game);
 
+    bool idle();
+
+    bool threaded() { return true; }
+    void handle_event(GameEngine* game, const SDL_Event& event);
+
     static PlayState* Instance() { return &m_playstate; }
 
  protected:
@@ -40,20 +56,20 @@ class PlayState : public GameState {
  private:
     static PlayState m_playstate;
 
+    void step(GameEngine* game);
+    void publish_frame();
     void release_tetromino();
     void copyColor();
     void check_all(int& x_val, int& num_rot); //returns x and # right rotations
-    std::vector<std::pair<int, int>> check_all_xpos(); //helper function to check_all()
     bool adjacent_occupied(int k, int j);
     int count_pits(int length);
     int empty_spots(int i);
     int cost();
-    bool checkInBounds();
-    bool checkCollision();
-    void draw_block(GameEngine* game, int x, int y, int k, SDL_Rect clips[]);
-    void create_button(GameEngine* game,
-            int x, int y, int width, int height, int color[]);
+    void draw_block(int x, int y, int k);
+    void update_board_layer(GameEngine* game, const PlayFrame& frame);
+    void update_particles(const PlayFrame& frame);
     float frame_rate(GameEngine* game, int *last_time, int *this_time);
+    void record_checksum();
 
     // Game objects.
     Board* board;
@@ -61,31 +77,37 @@ class PlayState : public GameState {
     Tetromino* next_tetro;
 
     int test_board[30][15];
-    Tetromino* test_tetro;
 
-    // Music.
+    // Music. Borrowed from GameEngine::assets, like the textures and fonts.
     irrklang::ISoundEngine* music_engine;
-
-    // Texture.
-    SDL_Texture* block_texture;
+    irrklang::ISoundSource* music;
+
+    // Textures.
+    SpriteAtlas* atlas;
+    SDL_FRect block_uv[NCOLORS];  // Block sprite of each tetromino type.
+    SDL_FRect white_uv;  // Solid white area, for the shadow.
+    SpriteBatch sprites;  // Every block of a frame, drawn at once.
+    SDL_Texture* board_layer;  // Locked blocks, rows are redrawn only
+                               // when they differ from layer_color.
+    int layer_color[Board::ROWS][Board::COLS];
+    std::atomic<bool> layer_lost;  // Render targets were reset.
+    bool cursor_shown;
+
+    // Written by update(), read by render().
+    TripleBuffer<PlayFrame> frames;
+    PlayEffects effects;  // Copied into every frame.
+
+    // Line clear and lock effects, main thread only.
+    ParticleSystem particles;
+    uint32_t shown_clears;  // Effects of the last frame drawn.
+    uint32_t shown_locks;
+    Uint32 particle_time;  // SDL_GetTicks() of the last particle update.
 
     // Fonts.
-    SDL_Color       white;
-    TTF_Font*       font_pause;
-    TTF_Font*       font_tetris;
-    TTF_Font*       font_score_text;
-    TTF_Font*       font_score;
-    TTF_Font*       font_new_game;
-    TTF_Font*       font_quit;
-    TTF_Font*       font_game_over;
-
-    SDL_Texture*    font_image_pause;
-    SDL_Texture*    font_image_tetris;
-    SDL_Texture*    font_image_score_text;
-    SDL_Texture*    font_image_score;
-    SDL_Texture*    font_image_new_game;
-    SDL_Texture*    font_image_quit;
-    SDL_Texture*    font_image_game_over;
+    GlyphAtlas*     text_small;  // Title, "Pause" and "Game over!".
+    GlyphAtlas*     text_large;  // Score and buttons.
+    SpriteBatch     small_batch;  // Text queued during render(), drawn
+    SpriteBatch     large_batch;  // after everything else.
 
     // Frame rate.
     float acceleration;  // Multiplied by score to provide falling speed.
@@ -108,9 +130,17 @@ class PlayState : public GameState {
     int newgamey1;
     int newgamey2;
 
+    FrameProfiler* profiler;  // Times check_all.
+
+    // Determinism checks.
+    ChecksumLog checksums;  // Written when --checksums is given.
+    uint32_t tick;  // Number of simulated updates since load.
+
     bool paused;
     bool game_over;  // True when player looses.
-    bool exit;  // True when player exits game.
+    bool quitting;  // True when player exits game.
+    bool to_menu;  // True when player goes back to the menu.
+    bool show_cursor;  // False while the mouse is over the board.
 };
 
 #endif  // SRC_PLAYSTATE_H_
@@ -0,0 +1,69 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/primitive_batch.h"
+
+#include <cmath>
+
+#include "src/profiler.h"
+#include "src/sprite_batch.h"
+
+void PrimitiveBatch::fill(const SDL_Rect& rect, SDL_Color color) {
+    float x1 = static_cast<float>(rect.x);
+    float y1 = static_cast<float>(rect.y);
+    float x2 = static_cast<float>(rect.x + rect.w);
+    float y2 = static_cast<float>(rect.y + rect.h);
+    SDL_FPoint corners[4] = { { x1, y1 }, { x2, y1 }, { x1, y2 }, { x2, y2 } };
+    quad(corners, color);
+}
+
+void PrimitiveBatch::line(int x1, int y1, int x2, int y2, SDL_Color color) {
+    // A quad one pixel wide around the segment joining the pixel centers,
+    // extended by half a pixel at both ends. Horizontal and vertical lines
+    // cover exactly the pixels SDL_RenderDrawLine would.
+    float dx = static_cast<float>(x2 - x1);
+    float dy = static_cast<float>(y2 - y1);
+    float length = std::sqrt(dx*dx + dy*dy);
+    if (length == 0.0f) {
+        dx = 1.0f;
+        length = 1.0f;
+    }
+    dx *= 0.5f / length;  // Half pixel along the line...
+    dy *= 0.5f / length;
+    float nx = -dy, ny = dx;  // ...and across it.
+
+    float ax = x1 + 0.5f - dx, ay = y1 + 0.5f - dy;
+    float bx = x2 + 0.5f + dx, by = y2 + 0.5f + dy;
+    SDL_FPoint corners[4] = {
+        { ax - nx, ay - ny }, { bx - nx, by - ny },
+        { ax + nx, ay + ny }, { bx + nx, by + ny } };
+    quad(corners, color);
+}
+
+void PrimitiveBatch::outline(const SDL_Rect& rect, SDL_Color color) {
+    int right = rect.x + rect.w - 1;
+    int bottom = rect.y + rect.h - 1;
+    fill({ rect.x, rect.y, rect.w, 1 }, color);
+    fill({ rect.x, bottom, rect.w, 1 }, color);
+    fill({ rect.x, rect.y + 1, 1, rect.h - 2 }, color);
+    fill({ right, rect.y + 1, 1, rect.h - 2 }, color);
+}
+
+void PrimitiveBatch::quad(const SDL_FPoint corners[4], SDL_Color color) {
+    for (int i = 0; i < 4; i++) {
+        SDL_Vertex vertex = { corners[i], color, { 0.0f, 0.0f } };
+        vertices.push_back(vertex);
+    }
+
+    extend_quad_indices(&indices, size());
+}
+
+void PrimitiveBatch::flush(SDL_Renderer* renderer) {
+    if (!vertices.empty()) {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_RenderGeometry(renderer, nullptr,
+                &vertices[0], static_cast<int>(vertices.size()),
+                &indices[0], 6*size());
+        FrameProfiler::count_draw_calls();
+    }
+    vertices.clear();
+}
@@ -0,0 +1,35 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_PRIMITIVE_BATCH_H_
+#define SRC_PRIMITIVE_BATCH_H_
+
+#include <SDL2/SDL.h>
+
+#include <vector>
+
+// Immediate-mode lines and filled rectangles of any colors, drawn together
+// with a single SDL_RenderGeometry call. Colors are stored per vertex, so
+// primitives of different colors share the call and keep their order,
+// with no SDL_SetRenderDrawColor in between. Buffers keep their capacity
+// between frames.
+class PrimitiveBatch {
+ public:
+    void fill(const SDL_Rect& rect, SDL_Color color);
+    // One pixel wide, both end points included, like SDL_RenderDrawLine.
+    void line(int x1, int y1, int x2, int y2, SDL_Color color);
+    // One pixel wide border of rect, like SDL_RenderDrawRect.
+    void outline(const SDL_Rect& rect, SDL_Color color);
+
+    // Draws the queued primitives, alpha-blended, and empties the batch.
+    void flush(SDL_Renderer* renderer);
+
+    int size() const { return static_cast<int>(vertices.size() / 4); }
+
+ private:
+    void quad(const SDL_FPoint corners[4], SDL_Color color);
+
+    std::vector<SDL_Vertex> vertices;  // 4 per quad.
+    std::vector<int> indices;  // 6 per quad, only ever grows.
+};
+
+#endif  // SRC_PRIMITIVE_BATCH_H_
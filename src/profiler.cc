@@ -0,0 +1,152 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+int FrameProfiler::draw_calls = 0;
+
+namespace {
+    const char* const SECTION_NAMES[] = { "input", "update", "render", "ai" };
+
+    // Milliseconds the graph is scaled to: two 60 Hz frames.
+    const float GRAPH_MS = 33.3f;
+    const int GRAPH_HEIGHT = 60;
+}
+
+FrameProfiler::FrameProfiler()
+    : head(0), count(0), frame_start(0), shown(false), watching(false) {
+    ms_per_tick = 1.0;
+    for (int i = 0; i < SECTIONS; i++)
+        pending[i] = 0;
+}
+
+FrameProfiler::~FrameProfiler() {
+    destroy();
+}
+
+void FrameProfiler::init() {
+    ms_per_tick = 1000.0 / SDL_GetPerformanceFrequency();
+    frame_start = SDL_GetPerformanceCounter();
+    SDL_AddEventWatch(watch, this);
+    watching = true;
+}
+
+void FrameProfiler::destroy() {
+    if (watching)
+        SDL_DelEventWatch(watch, this);
+    watching = false;
+}
+
+// Toggles the overlay whatever state is running, since every state polls
+// its own events.
+int FrameProfiler::watch(void* profiler, SDL_Event* event) {
+    if (event->type == SDL_KEYDOWN && !event->key.repeat &&
+            event->key.keysym.sym == SDLK_F3) {
+        FrameProfiler* self = static_cast<FrameProfiler*>(profiler);
+        self->shown = !self->shown;
+    }
+    return 0;
+}
+
+void FrameProfiler::begin_frame() {
+    draw_calls = 0;
+}
+
+void FrameProfiler::end_frame() {
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    Sample& sample = history[head];
+    sample.frame = static_cast<float>((now - frame_start)*ms_per_tick);
+    for (int i = 0; i < SECTIONS; i++)
+        sample.section[i] =
+            static_cast<float>(pending[i].exchange(0)*ms_per_tick);
+    sample.draw_calls = draw_calls;
+
+    head = (head + 1) % HISTORY;
+    count = std::min(count + 1, HISTORY);
+    frame_start = now;
+}
+
+void FrameProfiler::add(Section section, uint64_t counter_ticks) {
+    pending[section] += counter_ticks;
+}
+
+// Frame time below which p percent of the recorded frames fall.
+float FrameProfiler::percentile(float p) {
+    if (count == 0)
+        return 0.0f;
+    for (int i = 0; i < count; i++)
+        sorted[i] = history[i].frame;
+    int k = std::min(static_cast<int>(p / 100.0f * count), count - 1);
+    std::nth_element(sorted, sorted + k, sorted + count);
+    return sorted[k];
+}
+
+float FrameProfiler::average(int section) const {
+    float total = 0.0f;
+    for (int i = 0; i < count; i++)
+        total += history[i].section[section];
+    return count ? total / count : 0.0f;
+}
+
+void FrameProfiler::render(SDL_Renderer* renderer, const GlyphAtlas* text) {
+    if (!shown)
+        return;
+    if (text == nullptr) {
+        shown = false;
+        return;
+    }
+
+    const int x = 8;
+    const int y = 8;
+    const int line = text->height();
+    const int width = HISTORY + 8;
+    const int height = (2 + SECTIONS)*line + GRAPH_HEIGHT + 12;
+
+    // Translucent background.
+    SDL_Rect background = { x - 4, y - 4, width, height };
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(renderer, &background);
+
+    text_batch.begin(text->get_texture());
+    char buffer[64];
+
+    std::snprintf(buffer, sizeof(buffer),
+            "frame p50 %.2f  p95 %.2f  p99 %.2f ms",
+            percentile(50), percentile(95), percentile(99));
+    text->draw(&text_batch, buffer, x, y);
+
+    for (int i = 0; i < SECTIONS; i++) {
+        std::snprintf(buffer, sizeof(buffer), "%-7s %.3f ms",
+                SECTION_NAMES[i], average(i));
+        text->draw(&text_batch, buffer, x, y + (1 + i)*line);
+    }
+
+    int last = (head + HISTORY - 1) % HISTORY;
+    std::snprintf(buffer, sizeof(buffer), "draw calls %d",
+            count ? history[last].draw_calls : 0);
+    text->draw(&text_batch, buffer, x, y + (1 + SECTIONS)*line);
+
+    render_graph(renderer, x, y + (2 + SECTIONS)*line + 4);
+    text_batch.flush(renderer);
+}
+
+// Sparkline of frame times, oldest on the left, one pixel per frame.
+void FrameProfiler::render_graph(SDL_Renderer* renderer, int x, int y) {
+    int first = (head + HISTORY - count) % HISTORY;
+    for (int i = 0; i < count; i++) {
+        float ms = history[(first + i) % HISTORY].frame;
+        int h = static_cast<int>(std::min(ms / GRAPH_MS, 1.0f)*GRAPH_HEIGHT);
+        bars[i] = { x + HISTORY - count + i, y + GRAPH_HEIGHT - h, 1, h };
+    }
+    SDL_SetRenderDrawColor(renderer, 80, 220, 80, 255);
+    SDL_RenderFillRects(renderer, bars, count);
+
+    // 60 Hz budget.
+    SDL_SetRenderDrawColor(renderer, 220, 80, 80, 255);
+    int budget = y + GRAPH_HEIGHT - GRAPH_HEIGHT/2;
+    SDL_RenderDrawLine(renderer, x, budget, x + HISTORY, budget);
+}
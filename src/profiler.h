@@ -0,0 +1,102 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_PROFILER_H_
+#define SRC_PROFILER_H_
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+
+#include "src/glyph_atlas.h"
+#include "src/sprite_batch.h"
+
+// Frame-time profiler with an overlay toggled by F3. Keeps the last
+// HISTORY frames in a fixed ring buffer: frame time, time spent in each
+// Section and draw calls. Nothing is allocated after the overlay's font
+// has been loaded.
+class FrameProfiler {
+ public:
+    enum Section {
+        INPUT,
+        UPDATE,
+        RENDER,
+        AI,  // PlayState::check_all, part of UPDATE.
+        SECTIONS
+    };
+
+    static const int HISTORY = 240;
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    // Watches for the toggle key. Needs SDL video to be initialized.
+    void init();
+    void destroy();
+
+    // Frame boundaries, called by the main loop.
+    void begin_frame();
+    void end_frame();
+
+    // Adds time to a section of the current frame. Thread-safe, so the
+    // simulation thread of the threaded mode can report too.
+    void add(Section section, uint64_t counter_ticks);
+
+    // Times a section for as long as it is in scope.
+    class Scope {
+     public:
+        Scope(FrameProfiler* profiler, Section section)
+            : profiler(profiler), section(section),
+              start(SDL_GetPerformanceCounter()) { }
+        ~Scope() {
+            profiler->add(section, SDL_GetPerformanceCounter() - start);
+        }
+
+     private:
+        FrameProfiler* profiler;
+        Section section;
+        uint64_t start;
+    };
+
+    // Renderer calls issued this frame. Only counted on the main thread.
+    static void count_draw_calls(int calls = 1) { draw_calls += calls; }
+
+    bool visible() const { return shown; }
+
+    // Draws the overlay if visible, on top of the frame, with the glyphs
+    // of text. Hides it if text is null.
+    void render(SDL_Renderer* renderer, const GlyphAtlas* text);
+
+ private:
+    FrameProfiler(const FrameProfiler&);
+    FrameProfiler& operator=(const FrameProfiler&);
+
+    static int SDLCALL watch(void* profiler, SDL_Event* event);
+    float percentile(float p);
+    float average(int section) const;
+    void render_graph(SDL_Renderer* renderer, int x, int y);
+
+    struct Sample {
+        float frame;  // Milliseconds.
+        float section[SECTIONS];
+        int draw_calls;
+    };
+
+    static int draw_calls;
+
+    Sample history[HISTORY];
+    int head;  // Next slot to write.
+    int count;
+    float sorted[HISTORY];  // Scratch space for percentiles.
+
+    double ms_per_tick;
+    uint64_t frame_start;
+    std::atomic<uint64_t> pending[SECTIONS];
+
+    std::atomic<bool> shown;
+    bool watching;
+
+    SpriteBatch text_batch;
+    SDL_Rect bars[HISTORY];
+};
+
+#endif  // SRC_PROFILER_H_
@@ -0,0 +1,280 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/soft_renderer.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "src/tetromino.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const int GAME_OFFSET = PlayLayout::GAME_OFFSET;
+    const int BW = Board::BLOCK_WIDTH;
+    const int BH = Board::BLOCK_HEIGHT;
+    const int BUTTON_X = PlayLayout::BUTTON_X;
+    const int BUTTON_W = PlayLayout::BUTTON_WIDTH;
+    const int BUTTON_H = PlayLayout::BUTTON_HEIGHT;
+    const int NEWGAME_Y = PlayLayout::NEWGAME_Y;
+    const int QUIT_Y = PlayLayout::QUIT_Y;
+    const int LABEL = PlayLayout::LABEL_OFFSET;
+
+#if defined(__SSE2__)
+    // Two pixels as 16-bit channels: src multiplied by tint1 (tint + 1),
+    // then blended over dst with its own alpha.
+    inline __m128i blend2(__m128i s, __m128i d, __m128i tint1) {
+        const __m128i max = _mm_set1_epi16(255);
+        const __m128i half = _mm_set1_epi16(128);
+        s = _mm_srli_epi16(_mm_mullo_epi16(s, tint1), 8);
+        __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+        __m128i x = _mm_add_epi16(_mm_mullo_epi16(s, a),
+                _mm_mullo_epi16(d, _mm_sub_epi16(max, a)));
+        // Divide by 255, rounded.
+        x = _mm_add_epi16(x, half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+#endif
+
+    // dst = src*tint over dst, for n RGBA32 pixels.
+    void blend_row(uint32_t* dst, const uint32_t* src, int n, uint32_t tint) {
+        int i = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i tint1 = _mm_add_epi16(
+                _mm_unpacklo_epi8(_mm_set1_epi32(tint), zero),
+                _mm_set1_epi16(1));
+        for (; i + 4 <= n; i += 4) {
+            __m128i s = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + i));
+            __m128i d = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(dst + i));
+            __m128i lo = blend2(_mm_unpacklo_epi8(s, zero),
+                    _mm_unpacklo_epi8(d, zero), tint1);
+            __m128i hi = blend2(_mm_unpackhi_epi8(s, zero),
+                    _mm_unpackhi_epi8(d, zero), tint1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                    _mm_packus_epi16(lo, hi));
+        }
+#endif
+        const uint8_t* t = reinterpret_cast<const uint8_t*>(&tint);
+        for (; i < n; i++) {
+            const uint8_t* s = reinterpret_cast<const uint8_t*>(src + i);
+            uint8_t* d = reinterpret_cast<uint8_t*>(dst + i);
+            int tinted[4];
+            for (int c = 0; c < 4; c++)
+                tinted[c] = (s[c]*(t[c] + 1)) >> 8;
+            int a = tinted[3];
+            for (int c = 0; c < 4; c++) {
+                int x = tinted[c]*a + d[c]*(255 - a) + 128;
+                d[c] = (x + (x >> 8)) >> 8;
+            }
+        }
+    }
+
+    void fill_row(uint32_t* dst, int n, uint32_t color) {
+        int i = 0;
+#if defined(__SSE2__)
+        const __m128i c = _mm_set1_epi32(color);
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+#endif
+        for (; i < n; i++)
+            dst[i] = color;
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer()
+    : canvas(WIDTH*HEIGHT), font_small(nullptr), font_large(nullptr) {
+    sprites.surface = small_glyphs.surface = large_glyphs.surface = nullptr;
+}
+
+// Channels in memory order, whatever the endianness.
+uint32_t SoftwareRenderer::rgba(int r, int g, int b, int a) {
+    uint8_t bytes[4] = { static_cast<uint8_t>(r), static_cast<uint8_t>(g),
+        static_cast<uint8_t>(b), static_cast<uint8_t>(a) };
+    uint32_t color;
+    std::memcpy(&color, bytes, sizeof(color));
+    return color;
+}
+
+bool SoftwareRenderer::init() {
+    destroy();
+
+    // Same sprites and fonts as PlayState.
+    if (!load(atlas.load_pixels("resources/sprites/atlas.txt"), &sprites))
+        return false;
+    for (int i = 0; i < 7; i++) {
+        int id;
+        if (!atlas.require("block" + std::to_string(i), &id))
+            return false;
+        block_rect[i] = atlas.rect(id);
+    }
+    white_rect = atlas.rect(atlas.white());
+
+    font_small = TTF_OpenFont("resources/fonts/bitwise.ttf", 16);
+    font_large = TTF_OpenFont("resources/fonts/bitwise.ttf", 20);
+    if (font_small == nullptr || font_large == nullptr) {
+        std::cerr << "cannot open font: " << TTF_GetError() << std::endl;
+        return false;
+    }
+    return load(text_small.build_pixels(font_small), &small_glyphs) &&
+        load(text_large.build_pixels(font_large), &large_glyphs);
+}
+
+void SoftwareRenderer::destroy() {
+    Image* images[] = { &sprites, &small_glyphs, &large_glyphs };
+    for (int i = 0; i < 3; i++) {
+        if (images[i]->surface != nullptr)
+            SDL_FreeSurface(images[i]->surface);
+        images[i]->surface = nullptr;
+    }
+    atlas.destroy();
+    if (font_small != nullptr)
+        TTF_CloseFont(font_small);
+    if (font_large != nullptr)
+        TTF_CloseFont(font_large);
+    font_small = font_large = nullptr;
+}
+
+// Takes ownership of surface and converts it to RGBA32.
+bool SoftwareRenderer::load(SDL_Surface* surface, Image* image) {
+    if (surface == nullptr)
+        return false;
+    image->surface = SDL_ConvertSurfaceFormat(surface,
+            SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (image->surface == nullptr) {
+        std::cerr << "cannot convert image: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    image->pixels = static_cast<const uint32_t*>(image->surface->pixels);
+    image->pitch = image->surface->pitch / 4;
+    return true;
+}
+
+void SoftwareRenderer::fill(SDL_Rect rect, uint32_t color) {
+    int x0 = std::max(rect.x, 0), x1 = std::min(rect.x + rect.w, WIDTH);
+    int y0 = std::max(rect.y, 0), y1 = std::min(rect.y + rect.h, HEIGHT);
+    for (int y = y0; y < y1; y++)
+        fill_row(&canvas[y*WIDTH + x0], x1 - x0, color);
+}
+
+void SoftwareRenderer::blend(const Image& image, SDL_Rect src, int x, int y,
+        uint32_t tint) {
+    // Clip to the canvas.
+    if (x < 0) {
+        src.x -= x;
+        src.w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        src.y -= y;
+        src.h += y;
+        y = 0;
+    }
+    src.w = std::min(src.w, WIDTH - x);
+    src.h = std::min(src.h, HEIGHT - y);
+    if (src.w <= 0)
+        return;
+
+    for (int row = 0; row < src.h; row++)
+        blend_row(&canvas[(y + row)*WIDTH + x],
+                image.pixels + (src.y + row)*image.pitch + src.x,
+                src.w, tint);
+}
+
+void SoftwareRenderer::draw_block(int x, int y, int type) {
+    blend(sprites, block_rect[type], x, y, rgba(255, 255, 255, 255));
+}
+
+int SoftwareRenderer::draw_text(const GlyphAtlas& font, const Image& image,
+        const char* text, int x, int y) {
+    int pen = x;
+    for (const char* c = text; *c; c++) {
+        const SDL_Rect& src = font.source(*c);
+        if (src.w > 0)
+            blend(image, src, pen, y, rgba(255, 255, 255, 255));
+        pen += font.advance(*c);
+    }
+    return pen - x;
+}
+
+void SoftwareRenderer::render(const PlayFrame& frame) {
+    // Clear screen.
+    fill({ 0, 0, WIDTH, HEIGHT }, rgba(0, 0, 0, 255));
+
+    // Falling tetromino, its shadow on top, and the next tetromino.
+    for (int i = 0; i < Tetromino::SIZE; i++)
+        draw_block(frame.block_x[i]*BW + GAME_OFFSET,
+                frame.block_y[i]*BH + GAME_OFFSET, frame.type);
+    for (int i = 0; i < Tetromino::SIZE; i++) {
+        if (frame.shadow_y[i] < 0)
+            break;
+        fill({ frame.block_x[i]*BW + GAME_OFFSET,
+                frame.shadow_y[i]*BW + GAME_OFFSET, BW, BH },
+                rgba(180, 180, 180, 255));
+    }
+    if (!frame.game_over)
+        for (int i = 0; i < Tetromino::SIZE; i++)
+            draw_block(frame.next_x[i]*BW, frame.next_y[i]*BH,
+                    frame.next_type);
+
+    // Locked blocks.
+    for (int i = 0; i < Board::ROWS; i++)
+        for (int j = 0; j < Board::COLS; j++)
+            if (frame.color[i][j] != -1)
+                draw_block(j*BW + GAME_OFFSET, i*BH + GAME_OFFSET,
+                        frame.color[i][j]);
+
+    // Box surrounding board.
+    uint32_t gray = rgba(180, 180, 180, 255);
+    fill({ GAME_OFFSET, GAME_OFFSET, 1, Board::HEIGHT + 1 }, gray);
+    fill({ GAME_OFFSET + Board::WIDTH, GAME_OFFSET, 1, Board::HEIGHT + 1 },
+            gray);
+    fill({ GAME_OFFSET, GAME_OFFSET, Board::WIDTH + 1, 1 }, gray);
+    fill({ GAME_OFFSET, GAME_OFFSET + Board::HEIGHT, Board::WIDTH + 1, 1 },
+            gray);
+
+    // Buttons.
+    fill({ BUTTON_X, NEWGAME_Y, BUTTON_W, BUTTON_H }, rgba(0, 0, 255, 255));
+    fill({ BUTTON_X, QUIT_Y, BUTTON_W, BUTTON_H }, rgba(255, 0, 0, 255));
+
+    // Text, small font then large font, as PlayState queues it.
+    int x = PlayLayout::TEXT_X;
+    int y = PlayLayout::TEXT_Y;
+    draw_text(text_small, small_glyphs, "Tetris Unleashed!", x, y);
+    if (frame.paused)
+        draw_text(text_small, small_glyphs, "Pause", x, y + 40);
+    if (frame.game_over)
+        draw_text(text_small, small_glyphs, "Game over!", BUTTON_X,
+                PlayLayout::GAME_OVER_Y);
+
+    char score[16];
+    std::snprintf(score, sizeof(score), "%d", frame.score);
+    draw_text(text_large, large_glyphs, "Score: ", x, y + BW);
+    draw_text(text_large, large_glyphs, score, x + 60, y + BW);
+    draw_text(text_large, large_glyphs, "New game",
+            BUTTON_X + LABEL, NEWGAME_Y + LABEL);
+    draw_text(text_large, large_glyphs, "Quit",
+            BUTTON_X + LABEL, QUIT_Y + LABEL);
+}
+
+bool SoftwareRenderer::save_png(const std::string& path) const {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+            const_cast<uint32_t*>(pixels()), WIDTH, HEIGHT, 32, WIDTH*4,
+            SDL_PIXELFORMAT_RGBA32);
+    bool ok = surface != nullptr && IMG_SavePNG(surface, path.c_str()) == 0;
+    if (surface != nullptr)
+        SDL_FreeSurface(surface);
+    return ok;
+}
+
+bool SoftwareRenderer::write_raw(FILE* file) const {
+    return std::fwrite(pixels(), 4, canvas.size(), file) == canvas.size();
+}
@@ -0,0 +1,85 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_SOFT_RENDERER_H_
+#define SRC_SOFT_RENDERER_H_
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdint.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "src/glyph_atlas.h"
+#include "src/play_frame.h"
+#include "src/sprite_atlas.h"
+
+// Draws the scene of PlayState::render into an RGBA buffer in memory,
+// without a window or GPU: only SDL surfaces, SDL_image and SDL_ttf are
+// used, to load the sprites and rasterize the fonts once. Blits and fills
+// work on four pixels at a time with SSE2 when available.
+//
+// Meant for headless runs: golden images and gameplay videos rendered far
+// faster than real time (see tools/render_frames.cc).
+class SoftwareRenderer {
+ public:
+    // Same window size as GameEngine.
+    static const int WIDTH = PlayLayout::WIDTH;
+    static const int HEIGHT = PlayLayout::HEIGHT;
+
+    SoftwareRenderer();
+    ~SoftwareRenderer() { destroy(); }
+
+    // Loads sprites and fonts. TTF_Init() must have been called. Returns
+    // false (and reports on stderr) on failure.
+    bool init();
+    void destroy();
+
+    void render(const PlayFrame& frame);
+
+    // Pixels of the last frame, row by row, 4 bytes per pixel in R, G, B,
+    // A order (SDL_PIXELFORMAT_RGBA32).
+    const uint32_t* pixels() const { return &canvas[0]; }
+
+    bool save_png(const std::string& path) const;
+    // Appends the raw pixels to file, e.g. a stream for a video encoder.
+    bool write_raw(FILE* file) const;
+
+ private:
+    SoftwareRenderer(const SoftwareRenderer&);
+    SoftwareRenderer& operator=(const SoftwareRenderer&);
+
+    struct Image {
+        SDL_Surface* surface;  // RGBA32.
+        const uint32_t* pixels;
+        int pitch;  // In pixels.
+    };
+
+    bool load(SDL_Surface* surface, Image* image);
+    void fill(SDL_Rect rect, uint32_t color);
+    // Alpha-blends src of image at (x, y), multiplied by tint.
+    void blend(const Image& image, SDL_Rect src, int x, int y,
+            uint32_t tint);
+    void draw_block(int x, int y, int type);
+    int draw_text(const GlyphAtlas& font, const Image& image,
+            const char* text, int x, int y);
+
+    static uint32_t rgba(int r, int g, int b, int a);
+
+    std::vector<uint32_t> canvas;
+
+    SpriteAtlas atlas;
+    Image sprites;
+    SDL_Rect block_rect[7];
+    SDL_Rect white_rect;
+
+    TTF_Font* font_small;
+    TTF_Font* font_large;
+    GlyphAtlas text_small;
+    GlyphAtlas text_large;
+    Image small_glyphs;
+    Image large_glyphs;
+};
+
+#endif  // SRC_SOFT_RENDERER_H_
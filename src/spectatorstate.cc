@@ -0,0 +1,148 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/spectatorstate.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "src/board_texture.h"
+#include "src/bot.h"
+#include "src/tournament.h"
+
+SpectatorState SpectatorState::m_spectatorstate;
+
+bool SpectatorState::load(GameEngine* game) {
+    text = game->assets.glyphs("resources/fonts/bitwise.ttf", 12,
+            game->renderer);
+    if (text == nullptr)
+        return false;
+
+    int games = std::max(game->options.spectate_games, 1);
+    for (int i = 0; i < games; i++) {
+        boards.push_back(new BoardTexture());
+        boards.back()->create(game->renderer);
+    }
+    layout(game, games);
+    return true;
+}
+
+void SpectatorState::unload(GameEngine* game) {
+    for (size_t i = 0; i < boards.size(); i++)
+        delete boards[i];
+    boards.clear();
+
+    game->assets.release(text);
+}
+
+// A new tournament each time.
+void SpectatorState::enter(GameEngine* game) {
+    quitting = false;
+
+    // Leave one core to the renderer.
+    int threads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    tournament = new Tournament(static_cast<int>(boards.size()),
+            std::max(threads, 1));
+    tournament->start();
+}
+
+void SpectatorState::exit(GameEngine* game) {
+    delete tournament;
+    tournament = nullptr;
+}
+
+void SpectatorState::pause() {}
+
+void SpectatorState::resume() {}
+
+// Chooses the number of columns giving the largest tiles.
+void SpectatorState::layout(GameEngine* game, int games) {
+    int label = text->height();
+    top = NUM_BOTS*label + MARGIN;
+
+    tile_width = 0;
+    for (int c = 1; c <= games; c++) {
+        int rows = (games + c - 1) / c;
+        int w = (game->width - MARGIN*(c + 1)) / c;
+        int h = (game->height - top - MARGIN*(rows + 1)) / rows - label;
+
+        // Boards are twice as tall as wide.
+        w = std::min(w, h / 2);
+        if (w > tile_width) {
+            tile_width = w;
+            columns = c;
+        }
+    }
+    tile_width = std::max(tile_width, 1);
+    tile_height = 2*tile_width;
+}
+
+void SpectatorState::input(GameEngine* game) {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        // Clicking 'x' or pressing F4.
+        if (event.type == SDL_QUIT)
+            quitting = true;
+
+        // Key is pressed.
+        if (event.type == SDL_KEYDOWN &&
+                event.key.keysym.sym == SDLK_ESCAPE)
+            quitting = true;
+    }
+}
+
+void SpectatorState::update(GameEngine* game) {
+    // Games are simulated by the tournament threads.
+    if (quitting)
+        game->quit();
+}
+
+void SpectatorState::render(GameEngine* game) {
+    // Clear screen.
+    SDL_SetRenderDrawColor(game->renderer, 0, 0, 0, 1);
+    SDL_RenderClear(game->renderer);
+
+    text_batch.begin(text->get_texture());
+
+    int games_per_bot[NUM_BOTS] = {};
+    int64_t score_per_bot[NUM_BOTS] = {};
+
+    int label = text->height();
+    int index = 0;
+    for (int w = 0; w < tournament->workers(); w++) {
+        const TournamentSnapshot& snapshot = tournament->snapshot(w);
+        for (int g = 0; g < snapshot.games.size(); g++, index++) {
+            int bot = snapshot.bot[g];
+            games_per_bot[bot] += snapshot.games_played[g];
+            score_per_bot[bot] += snapshot.total_score[g];
+
+            int x = MARGIN + (index % columns)*(tile_width + MARGIN);
+            int y = top + MARGIN +
+                (index / columns)*(tile_height + label + MARGIN);
+            SDL_Rect dst = { x, y, tile_width, tile_height };
+            boards[index]->update(snapshot.games, g);
+            boards[index]->draw(game->renderer, dst);
+
+            // Label: score of the running game.
+            text->draw_number(&text_batch, snapshot.games.score[g],
+                    x, y + tile_height);
+        }
+    }
+
+    render_standings(games_per_bot, score_per_bot);
+    text_batch.flush(game->renderer);
+}
+
+// One line per bot: name, finished games and average score.
+void SpectatorState::render_standings(int games_per_bot[],
+        int64_t score_per_bot[]) {
+    for (int b = 0; b < NUM_BOTS; b++) {
+        int x = MARGIN;
+        int y = b*text->height();
+        x += text->draw(&text_batch, BOTS[b].name, x, y);
+        x += text->draw(&text_batch, ": ", x, y);
+        x += text->draw_number(&text_batch, games_per_bot[b], x, y);
+        x += text->draw(&text_batch, " games, average ", x, y);
+        text->draw_number(&text_batch, games_per_bot[b] ?
+                score_per_bot[b] / games_per_bot[b] : 0, x, y);
+    }
+}
@@ -0,0 +1,64 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_SPECTATORSTATE_H_
+#define SRC_SPECTATORSTATE_H_
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <vector>
+
+#include "src/gamestate.h"
+#include "src/glyph_atlas.h"
+#include "src/sprite_batch.h"
+
+class BoardTexture;
+class Tournament;
+
+// Watches a bot tournament: tiles every game of a Tournament in the window.
+// Games run on their own threads; this state only reads their latest
+// snapshots, so rendering never slows the simulation down.
+class SpectatorState : public GameState {
+ public:
+    bool load(GameEngine* game);
+    void unload(GameEngine* game);
+
+    void enter(GameEngine* game);
+    void exit(GameEngine* game);
+
+    void pause();
+    void resume();
+
+    void input(GameEngine* game);
+    void update(GameEngine* game);
+    void render(GameEngine* game);
+
+    static SpectatorState* Instance() { return &m_spectatorstate; }
+
+ protected:
+    SpectatorState() { }
+
+ private:
+    static SpectatorState m_spectatorstate;
+
+    void layout(GameEngine* game, int games);
+    void render_standings(int games_per_bot[], int64_t score_per_bot[]);
+
+    bool quitting;
+
+    Tournament* tournament;
+    std::vector<BoardTexture*> boards;  // One per game.
+
+    // Tiles.
+    int columns;
+    int tile_width;
+    int tile_height;  // Board only, the label goes below.
+    int top;  // Space above the tiles, for the standings.
+    static const int MARGIN = 6;
+
+    // Text.
+    GlyphAtlas* text;  // Borrowed from GameEngine::assets.
+    SpriteBatch text_batch;
+};
+
+#endif  // SRC_SPECTATORSTATE_H_
@@ -0,0 +1,226 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/sprite_atlas.h"
+
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "src/asset_pack.h"
+
+namespace {
+    const int PADDING = 2;  // Between sheets, so filtering never bleeds.
+    const int WHITE_SIZE = 4;
+    const int MAX_WIDTH = 2048;
+
+    struct Sheet {
+        SDL_Surface* image;
+        SDL_Rect place;  // Where the sheet goes in the atlas.
+    };
+
+    bool taller(const Sheet* a, const Sheet* b) {
+        return a->image->h > b->image->h;
+    }
+
+    SDL_Surface* load_sheet(const std::string& path, const AssetPack* assets) {
+        if (assets != nullptr && assets->find(path) != nullptr)
+            return assets->load_surface(path);
+        return IMG_Load(path.c_str());
+    }
+}
+
+bool SpriteAtlas::load(const std::string& descriptor, SDL_Renderer* renderer,
+        const AssetPack* assets) {
+    return upload(load_pixels(descriptor, assets), renderer);
+}
+
+bool SpriteAtlas::upload(SDL_Surface* atlas, SDL_Renderer* renderer) {
+    if (atlas != nullptr) {
+        texture = SDL_CreateTextureFromSurface(renderer, atlas);
+        SDL_FreeSurface(atlas);
+    }
+    if (texture == nullptr) {
+        destroy();
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+SDL_Surface* SpriteAtlas::load_pixels(const std::string& descriptor,
+        const AssetPack* assets) {
+    destroy();
+    SDL_Surface* atlas = pack(descriptor, assets);
+    if (atlas == nullptr)
+        destroy();
+    return atlas;
+}
+
+// Reads the descriptor, packs its sheets into one surface and fills in
+// the sprite rectangles and texture coordinates.
+SDL_Surface* SpriteAtlas::pack(const std::string& descriptor,
+        const AssetPack* assets) {
+    const AssetPack::Entry* packed =
+        assets != nullptr ? assets->find(descriptor) : nullptr;
+    std::istringstream packed_file;
+    std::ifstream disk_file;
+    if (packed != nullptr)
+        packed_file.str(std::string(
+                static_cast<const char*>(assets->data(*packed)),
+                packed->size));
+    else
+        disk_file.open(descriptor.c_str());
+    std::istream& file = packed != nullptr ?
+        static_cast<std::istream&>(packed_file) : disk_file;
+    if (!file) {
+        std::cerr << "cannot open sprite atlas " << descriptor << std::endl;
+        return nullptr;
+    }
+
+    // Read the descriptor: sheets, and sprites relative to their sheet.
+    std::vector<Sheet> sheets;
+    std::vector<int> sheet_of;  // Sheet index of each sprite.
+    std::string line;
+    int line_number = 0;
+    bool ok = true;
+    while (ok && std::getline(file, line)) {
+        line_number++;
+        std::istringstream in(line);
+        std::string word;
+        if (!(in >> word) || word[0] == '#')
+            continue;
+
+        SDL_Rect r;
+        if (word == "sheet") {
+            std::string path;
+            ok = static_cast<bool>(in >> path);
+            Sheet sheet = { ok ? load_sheet(path, assets) : nullptr, {} };
+            if (ok && sheet.image == nullptr) {
+                std::cerr << "cannot load sprite sheet " << path << ": "
+                    << SDL_GetError() << std::endl;
+                ok = false;
+            }
+            if (ok)
+                sheets.push_back(sheet);
+        } else if (sheets.empty()) {
+            ok = false;
+        } else if (word == "grid") {
+            std::string prefix;
+            int n, dx, dy;
+            ok = static_cast<bool>(in >> prefix >> r.x >> r.y >> r.w >> r.h
+                    >> n >> dx >> dy);
+            for (int i = 0; ok && i < n; i++) {
+                std::ostringstream name;
+                name << prefix << i;
+                names.push_back(name.str());
+                rects.push_back({ r.x + i*dx, r.y + i*dy, r.w, r.h });
+                sheet_of.push_back(sheets.size() - 1);
+            }
+        } else {
+            ok = static_cast<bool>(in >> r.x >> r.y >> r.w >> r.h);
+            if (ok) {
+                names.push_back(word);
+                rects.push_back(r);
+                sheet_of.push_back(sheets.size() - 1);
+            }
+        }
+
+        if (!ok)
+            std::cerr << descriptor << ":" << line_number
+                << ": malformed line" << std::endl;
+    }
+
+    // Shelf-pack the sheets, tallest first. The white area opens the
+    // first shelf.
+    std::vector<Sheet*> order;
+    int width = WHITE_SIZE + PADDING;
+    int widest = 0;
+    for (size_t i = 0; i < sheets.size(); i++) {
+        order.push_back(&sheets[i]);
+        width += sheets[i].image->w + PADDING;
+        widest = std::max(widest, sheets[i].image->w);
+    }
+    width = std::max(std::min(width, MAX_WIDTH),
+            WHITE_SIZE + PADDING + widest);
+    std::sort(order.begin(), order.end(), taller);
+
+    int x = WHITE_SIZE + PADDING, y = 0, shelf_height = WHITE_SIZE;
+    for (size_t i = 0; i < order.size(); i++) {
+        SDL_Surface* image = order[i]->image;
+        if (x + image->w > width) {
+            x = 0;
+            y += shelf_height + PADDING;
+            shelf_height = 0;
+        }
+        order[i]->place = { x, y, image->w, image->h };
+        x += image->w + PADDING;
+        shelf_height = std::max(shelf_height, image->h);
+    }
+
+    int height = y + shelf_height;
+    SDL_Surface* atlas = ok ? SDL_CreateRGBSurfaceWithFormat(0,
+            width, height, 32, SDL_PIXELFORMAT_ARGB8888) : nullptr;
+    if (atlas != nullptr) {
+        SDL_Rect white_area = { 0, 0, WHITE_SIZE, WHITE_SIZE };
+        SDL_FillRect(atlas, &white_area,
+                SDL_MapRGBA(atlas->format, 255, 255, 255, 255));
+        for (size_t i = 0; i < sheets.size(); i++) {
+            SDL_SetSurfaceBlendMode(sheets[i].image, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(sheets[i].image, nullptr, atlas, &sheets[i].place);
+        }
+    }
+    for (size_t i = 0; i < sheets.size(); i++)
+        SDL_FreeSurface(sheets[i].image);
+    if (atlas == nullptr)
+        return nullptr;
+
+    // Sprite rectangles become atlas rectangles.
+    for (size_t i = 0; i < rects.size(); i++) {
+        rects[i].x += sheets[sheet_of[i]].place.x;
+        rects[i].y += sheets[sheet_of[i]].place.y;
+    }
+
+    // Sample the middle of the white area only.
+    white_id = rects.size();
+    names.push_back("white");
+    rects.push_back({ 1, 1, WHITE_SIZE - 2, WHITE_SIZE - 2 });
+
+    // Texture coordinates: upper left corner in x, y and size in w, h.
+    for (size_t i = 0; i < rects.size(); i++) {
+        SDL_FRect uv = {
+            static_cast<float>(rects[i].x) / width,
+            static_cast<float>(rects[i].y) / height,
+            static_cast<float>(rects[i].w) / width,
+            static_cast<float>(rects[i].h) / height };
+        uvs.push_back(uv);
+    }
+    return atlas;
+}
+
+void SpriteAtlas::destroy() {
+    if (texture != nullptr) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    white_id = -1;
+    names.clear();
+    rects.clear();
+    uvs.clear();
+}
+
+int SpriteAtlas::find(const std::string& name) const {
+    for (size_t i = 0; i < names.size(); i++)
+        if (names[i] == name)
+            return i;
+    return -1;
+}
+
+bool SpriteAtlas::require(const std::string& name, int* id) const {
+    *id = find(name);
+    if (*id < 0)
+        std::cerr << "sprite atlas has no sprite " << name << std::endl;
+    return *id >= 0;
+}
@@ -0,0 +1,68 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_SPRITE_ATLAS_H_
+#define SRC_SPRITE_ATLAS_H_
+
+#include <SDL2/SDL.h>
+
+#include <string>
+#include <vector>
+
+class AssetPack;
+
+// Sprite sheets listed in a descriptor file (see
+// resources/sprites/atlas.txt), packed into one texture at load time.
+// Source rectangles and texture coordinates of every sprite are computed
+// once and looked up by id, so drawing never queries textures and all
+// sprites can share one SpriteBatch.
+class SpriteAtlas {
+ public:
+    SpriteAtlas() : texture(nullptr), white_id(-1) { }
+    ~SpriteAtlas() { destroy(); }
+
+    // Loads the descriptor and every sheet it lists, from assets when it
+    // has them and from disk otherwise. Returns false (and reports on
+    // stderr) if a file is missing or a line is malformed.
+    bool load(const std::string& descriptor, SDL_Renderer* renderer,
+            const AssetPack* assets = nullptr);
+    // Same, but returns the packed atlas as an ARGB8888 surface owned by
+    // the caller instead of uploading it, for software rendering. Returns
+    // null on failure.
+    SDL_Surface* load_pixels(const std::string& descriptor,
+            const AssetPack* assets = nullptr);
+    // Uploads and frees the surface of load_pixels(), which may run on
+    // another thread. Returns false on failure.
+    bool upload(SDL_Surface* pixels, SDL_Renderer* renderer);
+    void destroy();
+
+    SDL_Texture* get_texture() const { return texture; }
+
+    // Id of the named sprite, -1 if there is none.
+    int find(const std::string& name) const;
+    // Id of a sprite the caller cannot do without. Returns false (and
+    // reports on stderr) if the descriptor doesn't define it.
+    bool require(const std::string& name, int* id) const;
+
+    // Solid white sprite, to draw tinted rectangles from the atlas. Every
+    // loaded atlas has one.
+    int white() const { return white_id; }
+
+    // Position of a sprite in the atlas, in pixels and normalized.
+    const SDL_Rect& rect(int id) const { return rects[id]; }
+    const SDL_FRect& uv(int id) const { return uvs[id]; }
+
+ private:
+    SpriteAtlas(const SpriteAtlas&);
+    SpriteAtlas& operator=(const SpriteAtlas&);
+
+    SDL_Surface* pack(const std::string& descriptor, const AssetPack* assets);
+
+    SDL_Texture* texture;
+    int white_id;
+
+    std::vector<std::string> names;
+    std::vector<SDL_Rect> rects;
+    std::vector<SDL_FRect> uvs;
+};
+
+#endif  // SRC_SPRITE_ATLAS_H_
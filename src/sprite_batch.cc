@@ -0,0 +1,65 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/sprite_batch.h"
+
+#include "src/profiler.h"
+
+void SpriteBatch::begin(SDL_Texture* new_texture) {
+    texture = new_texture;
+    SDL_QueryTexture(texture, nullptr, nullptr,
+            &texture_width, &texture_height);
+    vertices.clear();
+}
+
+void SpriteBatch::add(const SDL_Rect& src, const SDL_Rect& dst,
+        SDL_Color tint) {
+    SDL_FRect uv = {
+        static_cast<float>(src.x) / texture_width,
+        static_cast<float>(src.y) / texture_height,
+        static_cast<float>(src.w) / texture_width,
+        static_cast<float>(src.h) / texture_height };
+    add(uv, dst, tint);
+}
+
+void SpriteBatch::add(const SDL_FRect& uv, const SDL_Rect& dst,
+        SDL_Color tint) {
+    float u1 = uv.x;
+    float v1 = uv.y;
+    float u2 = uv.x + uv.w;
+    float v2 = uv.y + uv.h;
+
+    float x1 = static_cast<float>(dst.x);
+    float y1 = static_cast<float>(dst.y);
+    float x2 = static_cast<float>(dst.x + dst.w);
+    float y2 = static_cast<float>(dst.y + dst.h);
+
+    SDL_Vertex corners[4] = {
+        { { x1, y1 }, tint, { u1, v1 } },
+        { { x2, y1 }, tint, { u2, v1 } },
+        { { x1, y2 }, tint, { u1, v2 } },
+        { { x2, y2 }, tint, { u2, v2 } },
+    };
+    vertices.insert(vertices.end(), corners, corners + 4);
+
+    extend_quad_indices(&indices, size());
+}
+
+void extend_quad_indices(std::vector<int>* indices, int quads) {
+    for (int quad = static_cast<int>(indices->size()) / 6; quad < quads;
+            quad++) {
+        int first = 4*quad;
+        int pattern[6] = { first, first + 1, first + 2,
+                           first + 2, first + 1, first + 3 };
+        indices->insert(indices->end(), pattern, pattern + 6);
+    }
+}
+
+void SpriteBatch::flush(SDL_Renderer* renderer) {
+    if (!vertices.empty()) {
+        SDL_RenderGeometry(renderer, texture,
+                &vertices[0], static_cast<int>(vertices.size()),
+                &indices[0], 6*size());
+        FrameProfiler::count_draw_calls();
+    }
+    vertices.clear();
+}
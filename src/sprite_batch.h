@@ -0,0 +1,48 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_SPRITE_BATCH_H_
+#define SRC_SPRITE_BATCH_H_
+
+#include <SDL2/SDL.h>
+
+#include <vector>
+
+// Grows indices to draw quads quads of 4 vertices each as two triangles
+// (0 1 2, 2 1 3). The pattern never changes, so only what is missing is
+// appended. Shared by every batcher drawing with SDL_RenderGeometry.
+void extend_quad_indices(std::vector<int>* indices, int quads);
+
+// Collects textured quads from one texture and draws them all with a
+// single SDL_RenderGeometry call. Buffers keep their capacity between
+// frames, so a steady frame does not allocate.
+class SpriteBatch {
+ public:
+    SpriteBatch() : texture(nullptr), texture_width(1), texture_height(1) { }
+
+    // Starts a new batch of quads sampled from texture.
+    void begin(SDL_Texture* texture);
+
+    // Queues src (in texture pixels) to be drawn at dst, multiplied by tint.
+    void add(const SDL_Rect& src, const SDL_Rect& dst,
+            SDL_Color tint = SDL_Color{255, 255, 255, 255});
+    // Same, with the source given as precomputed texture coordinates
+    // (upper left corner in x, y and size in w, h, see SpriteAtlas::uv).
+    void add(const SDL_FRect& uv, const SDL_Rect& dst,
+            SDL_Color tint = SDL_Color{255, 255, 255, 255});
+
+    // Draws the queued quads in the order they were added and empties the
+    // batch.
+    void flush(SDL_Renderer* renderer);
+
+    int size() const { return static_cast<int>(vertices.size() / 4); }
+
+ private:
+    SDL_Texture* texture;
+    int texture_width;
+    int texture_height;
+
+    std::vector<SDL_Vertex> vertices;  // 4 per quad.
+    std::vector<int> indices;  // 6 per quad, only ever grows.
+};
+
+#endif  // SRC_SPRITE_BATCH_H_
@@ -0,0 +1,77 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/startup_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    // Set during static initialization, before main().
+    const StartupTrace::Clock::time_point process_start =
+        StartupTrace::Clock::now();
+}
+
+StartupTrace::StartupTrace()
+    : enabled(false), main_thread(std::this_thread::get_id()),
+      first_frame_time(-1.0) { }
+
+double StartupTrace::milliseconds(Clock::time_point time) {
+    return std::chrono::duration<double, std::milli>(
+            time - process_start).count();
+}
+
+void StartupTrace::record(const std::string& name, Clock::time_point start) {
+    if (!enabled)
+        return;
+    Clock::time_point end = Clock::now();
+    Phase phase = { name, milliseconds(start),
+        milliseconds(end) - milliseconds(start),
+        std::this_thread::get_id() == main_thread };
+    std::lock_guard<std::mutex> guard(lock);
+    phases.push_back(phase);
+}
+
+void StartupTrace::first_frame() {
+    if (!enabled)
+        return;
+    double now = milliseconds(Clock::now());
+    std::lock_guard<std::mutex> guard(lock);
+    if (first_frame_time < 0.0)
+        first_frame_time = now;
+}
+
+bool StartupTrace::write(const std::string& path) const {
+    std::vector<Phase> sorted;
+    double first_frame_at;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        sorted = phases;
+        first_frame_at = first_frame_time;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+            [](const Phase& a, const Phase& b) { return a.start < b.start; });
+
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+        return false;
+    std::fprintf(file, "# startup timeline, ms since process start\n"
+            "#    start  duration  thread  phase\n");
+    bool frame_written = first_frame_at < 0.0;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        if (!frame_written && sorted[i].start > first_frame_at) {
+            std::fprintf(file, "%10.2f            main    first frame\n",
+                    first_frame_at);
+            frame_written = true;
+        }
+        std::fprintf(file, "%10.2f  %8.2f  %-6s  %s\n", sorted[i].start,
+                sorted[i].duration, sorted[i].main_thread ? "main" : "loader",
+                sorted[i].name.c_str());
+    }
+    if (!frame_written)
+        std::fprintf(file, "%10.2f            main    first frame\n",
+                first_frame_at);
+    if (first_frame_at >= 0.0)
+        std::fprintf(file, "# time to first frame: %.2f ms\n",
+                first_frame_at);
+    return std::fclose(file) == 0;
+}
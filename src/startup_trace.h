@@ -0,0 +1,71 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_STARTUP_TRACE_H_
+#define SRC_STARTUP_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Timeline of the game's startup: when each init phase (SDL, window,
+// renderer, SDL_ttf, every asset...) started, how long it took and on
+// which thread, up to the first presented frame and beyond. Times are in
+// milliseconds since the process started. Recording is thread-safe and
+// does nothing until enable() is called.
+class StartupTrace {
+ public:
+    typedef std::chrono::steady_clock Clock;
+
+    // The constructing thread is reported as "main".
+    StartupTrace();
+
+    void enable() { enabled = true; }
+    bool is_enabled() const { return enabled; }
+
+    // Records a phase that ran from start until now on this thread.
+    void record(const std::string& name, Clock::time_point start);
+
+    // Marks the end of the first presented frame. Later calls are ignored.
+    void first_frame();
+
+    // Writes the phases in start order. Returns false on I/O errors.
+    bool write(const std::string& path) const;
+
+    // Records a phase for as long as it is in scope.
+    class Scope {
+     public:
+        Scope(StartupTrace* trace, const std::string& name)
+            : trace(trace), name(name), start(Clock::now()) { }
+        ~Scope() { trace->record(name, start); }
+
+     private:
+        StartupTrace* trace;
+        std::string name;
+        Clock::time_point start;
+    };
+
+ private:
+    StartupTrace(const StartupTrace&);
+    StartupTrace& operator=(const StartupTrace&);
+
+    struct Phase {
+        std::string name;
+        double start;  // Milliseconds.
+        double duration;
+        bool main_thread;
+    };
+
+    static double milliseconds(Clock::time_point time);
+
+    std::atomic<bool> enabled;
+    std::thread::id main_thread;
+    double first_frame_time;  // Negative until the first frame.
+
+    mutable std::mutex lock;
+    std::vector<Phase> phases;
+};
+
+#endif  // SRC_STARTUP_TRACE_H_
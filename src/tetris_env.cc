@@ -0,0 +1,128 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/tetris_env.h"
+#include "src/tetris_env_c.h"
+
+TetrisEnv::TetrisEnv(int size, ObservationFormat format)
+    : batch(size), seeds(size) {
+    // Locked blocks and current piece only, see ObservationFormat.
+    observation.include_next = false;
+    observation.type = format == BIT_PACKED ?
+        ObservationOptions::BITS : ObservationOptions::UINT8;
+}
+
+int TetrisEnv::observation_size() const {
+    return observation.size();
+}
+
+void TetrisEnv::reset(const uint32_t* new_seeds, uint8_t* observations) {
+    int obs_size = observation_size();
+    for (int g = 0; g < size(); g++) {
+        seeds[g] = new_seeds ? new_seeds[g] : static_cast<uint32_t>(g + 1);
+        batch.reset(g, seeds[g]);
+        observe(g, observations + g*obs_size);
+    }
+}
+
+void TetrisEnv::step(const int32_t* actions,
+        uint8_t* observations, float* rewards, uint8_t* dones) {
+    int obs_size = observation_size();
+    for (int g = 0; g < size(); g++) {
+        int before = batch.score[g];
+        place(g, actions[g]);
+        rewards[g] = static_cast<float>(batch.score[g] - before);
+        dones[g] = batch.game_over[g];
+
+        if (dones[g]) {
+            // Linear congruential step so every env moves to a new seed.
+            seeds[g] = seeds[g]*1664525u + 1013904223u;
+            batch.reset(g, seeds[g]);
+        }
+        observe(g, observations + g*obs_size);
+    }
+}
+
+void TetrisEnv::legal_actions(uint8_t* mask) const {
+    for (int g = 0; g < size(); g++)
+        for (int a = 0; a < ACTIONS; a++)
+            mask[g*ACTIONS + a] = !batch.game_over[g] &&
+                !batch.collides(g, batch.type[g], a / COLS, a % COLS,
+                        batch.y[g]);
+}
+
+void TetrisEnv::place(int game, int32_t action) {
+    if (action >= 0 && action < ACTIONS) {
+        int rot = action / COLS;
+        int target = action % COLS;
+        int type = batch.type[game];
+        int y = batch.y[game];
+
+        // Columns the piece cannot reach are moved to the nearest column
+        // where it fits.
+        for (int d = 0; d < COLS; d++) {
+            if (target - d >= 0 &&
+                    !batch.collides(game, type, rot, target - d, y)) {
+                target -= d;
+                break;
+            }
+            if (target + d < COLS &&
+                    !batch.collides(game, type, rot, target + d, y)) {
+                target += d;
+                break;
+            }
+        }
+        if (!batch.collides(game, type, rot, target, y)) {
+            batch.rotation[game] = rot;
+            batch.x[game] = target;
+        }
+    }
+    batch.hard_drop(game);
+}
+
+void TetrisEnv::observe(int game, uint8_t* out) const {
+    export_observations(batch, game, 1, observation, out);
+}
+
+// C interface.
+
+struct tetris_env {
+    TetrisEnv env;
+
+    tetris_env(int size, TetrisEnv::ObservationFormat format)
+        : env(size, format) { }
+};
+
+tetris_env* tetris_env_create(int size, int observation_format) {
+    return new tetris_env(size, observation_format == TETRIS_ENV_BIT_PACKED ?
+            TetrisEnv::BIT_PACKED : TetrisEnv::UINT8_PLANES);
+}
+
+void tetris_env_destroy(tetris_env* env) {
+    delete env;
+}
+
+int tetris_env_size(const tetris_env* env) {
+    return env->env.size();
+}
+
+int tetris_env_num_actions(void) {
+    return TetrisEnv::ACTIONS;
+}
+
+int tetris_env_observation_size(const tetris_env* env) {
+    return env->env.observation_size();
+}
+
+void tetris_env_reset(tetris_env* env,
+        const uint32_t* seeds, uint8_t* observations) {
+    env->env.reset(seeds, observations);
+}
+
+void tetris_env_step(tetris_env* env, const int32_t* actions,
+        uint8_t* observations, float* rewards, uint8_t* dones) {
+    env->env.step(actions, observations, rewards, dones);
+}
+
+void tetris_env_legal_actions(const tetris_env* env, uint8_t* mask) {
+    env->env.legal_actions(mask);
+}
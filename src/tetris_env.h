@@ -0,0 +1,66 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_TETRIS_ENV_H_
+#define SRC_TETRIS_ENV_H_
+
+#include <stdint.h>
+
+#include "src/board_batch.h"
+#include "src/observation.h"
+
+// Batched training environment built on BoardBatch. No SDL involved.
+//
+// An action places the current piece the way PlayState::check_all does:
+// rotate it right num_rot times, move its (0, 0) block to column x and drop
+// it. Actions are encoded as num_rot*COLS + x. Finished games are reset
+// automatically, so the observation returned with done = 1 already belongs
+// to the next game.
+class TetrisEnv {
+ public:
+    static const int ROWS = BoardBatch::ROWS;
+    static const int COLS = BoardBatch::COLS;
+    static const int ACTIONS = 4*COLS;
+
+    enum ObservationFormat {
+        // Two ROWS x COLS planes of 0/1 bytes: locked blocks, then the
+        // blocks of the current piece at its spawn position.
+        UINT8_PLANES,
+        // The same two planes as ROWS little-endian 16-bit row masks each,
+        // bit c set if column c is occupied.
+        BIT_PACKED
+    };
+
+    TetrisEnv(int size, ObservationFormat format);
+
+    int size() const { return batch.size(); }
+
+    // Bytes written per game into observation buffers.
+    int observation_size() const;
+
+    // Starts a new game in every environment. seeds may be null.
+    // observations must hold size()*observation_size() bytes.
+    void reset(const uint32_t* seeds, uint8_t* observations);
+
+    // Plays one action per environment. rewards receive the score gained,
+    // dones are set to 1 for games that ended on this step.
+    void step(const int32_t* actions,
+            uint8_t* observations, float* rewards, uint8_t* dones);
+
+    // Writes 1 for every action that places the current piece of a game
+    // without colliding at spawn height, 0 otherwise. mask must hold
+    // size()*ACTIONS bytes.
+    void legal_actions(uint8_t* mask) const;
+
+    // Underlying games, e.g. to read piece types or statistics.
+    const BoardBatch& games() const { return batch; }
+
+ private:
+    void place(int game, int32_t action);
+    void observe(int game, uint8_t* out) const;
+
+    BoardBatch batch;
+    ObservationOptions observation;
+    std::vector<uint32_t> seeds;  // Seed of the running game, per env.
+};
+
+#endif  // SRC_TETRIS_ENV_H_
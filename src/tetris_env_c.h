@@ -0,0 +1,39 @@
+/* Copyright [2015] <Chafic Najjar> */
+
+/* Plain C interface to TetrisEnv, for trainers written in other languages.
+ * See src/tetris_env.h for the meaning of actions and observations. */
+
+#ifndef SRC_TETRIS_ENV_C_H_
+#define SRC_TETRIS_ENV_C_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tetris_env tetris_env;
+
+enum {
+    TETRIS_ENV_UINT8_PLANES = 0,
+    TETRIS_ENV_BIT_PACKED = 1
+};
+
+tetris_env* tetris_env_create(int size, int observation_format);
+void tetris_env_destroy(tetris_env* env);
+
+int tetris_env_size(const tetris_env* env);
+int tetris_env_num_actions(void);
+int tetris_env_observation_size(const tetris_env* env);
+
+void tetris_env_reset(tetris_env* env,
+        const uint32_t* seeds, uint8_t* observations);
+void tetris_env_step(tetris_env* env, const int32_t* actions,
+        uint8_t* observations, float* rewards, uint8_t* dones);
+void tetris_env_legal_actions(const tetris_env* env, uint8_t* mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* SRC_TETRIS_ENV_C_H_ */
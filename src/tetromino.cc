@@ -2,6 +2,7 @@
 
 #include "src/tetromino.h"
 #include "src/board.h"
+#include "src/hash.h"
 #include <iostream>
 
 const int Tetromino::coords_table[7][4][2] = {
@@ -48,6 +49,22 @@ Tetromino::Tetromino(int new_type) {
     update_width();
 }
 
+void Tetromino::rotated_coords(int type, int rot, int out[4][2]) {
+    for (int i = 0; i < SIZE; i++) {
+        int cx = coords_table[type][i][0];
+        int cy = coords_table[type][i][1];
+
+        // Same transformation as rotate_right(), applied rot times.
+        for (int r = 0; r < (rot & 3); r++) {
+            int temp = cx;
+            cx = cy;
+            cy = -temp;
+        }
+        out[i][0] = cx;
+        out[i][1] = cy;
+    }
+}
+
 void Tetromino::rotate_left() {
     for (int i = 0; i < SIZE; i++) {
         int temp = coords[i][0];
@@ -115,3 +132,16 @@ void Tetromino::get_shadow(Board *board, int shadow_y[]) {
     status = temp_status;
 }
 
+
+uint64_t Tetromino::hash() const {
+    uint64_t h = hash_mix(type);
+    h = hash_mix(h ^ static_cast<uint32_t>(x));
+    h = hash_mix(h ^ static_cast<uint32_t>(y));
+
+    // Block offsets are within [-2, 2]: 3 bits each identify the rotation.
+    uint64_t offsets = 0;
+    for (int i = 0; i < SIZE; i++)
+        offsets = (offsets << 6) |
+            ((coords[i][0] + 2) << 3) | (coords[i][1] + 2);
+    return hash_mix(h ^ offsets);
+}
@@ -3,6 +3,8 @@
 #ifndef SRC_TETROMINO_H_
 #define SRC_TETROMINO_H_
 
+#include <stdint.h>
+
 class Board;
 
 class Tetromino {
@@ -12,6 +14,10 @@ class Tetromino {
     static const int SIZE = 4;
     static const int coords_table[7][4][2];
 
+    // Coordinates of the blocks of a tetromino of the given type after
+    // rot right rotations, without building a Tetromino.
+    static void rotated_coords(int type, int rot, int out[4][2]);
+
     explicit Tetromino(int type);
 
     // Sets position of the block at (0, 0)
@@ -40,6 +46,9 @@ class Tetromino {
 
     void get_shadow(Board* board, int shadow_y[]);
 
+    // Hash of the type, position and orientation of the tetromino.
+    uint64_t hash() const;
+
     void update_width();
 
     Status status;
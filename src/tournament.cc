@@ -0,0 +1,114 @@
+// Copyright [2015] <Chafic Najjar>
+
+#include "src/tournament.h"
+
+#include <chrono>
+
+#include "src/bot.h"
+#include "src/tetris_env.h"
+
+namespace {
+    // Publishing copies every board of a thread, don't do it more often
+    // than a viewer could possibly show.
+    const std::chrono::milliseconds PUBLISH_INTERVAL(8);
+}
+
+Tournament::Tournament(int games, int thread_count) : running(false) {
+    if (thread_count < 1)
+        thread_count = 1;
+    if (thread_count > games)
+        thread_count = games;
+
+    // Split the games as evenly as possible.
+    int first = 0;
+    for (int i = 0; i < thread_count; i++) {
+        Worker* worker = new Worker;
+        worker->first_game = first;
+        worker->games = (games - first) / (thread_count - i);
+        first += worker->games;
+        pool.push_back(worker);
+    }
+}
+
+Tournament::~Tournament() {
+    stop();
+    for (size_t i = 0; i < pool.size(); i++)
+        delete pool[i];
+}
+
+void Tournament::start() {
+    if (running)
+        return;
+    running = true;
+    for (size_t i = 0; i < pool.size(); i++)
+        threads.push_back(std::thread(&Tournament::run, this, pool[i]));
+}
+
+void Tournament::stop() {
+    running = false;
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+    threads.clear();
+}
+
+const TournamentSnapshot& Tournament::snapshot(int worker) {
+    pool[worker]->snapshots.update();
+    return pool[worker]->snapshots.read_buffer();
+}
+
+void Tournament::run(Worker* worker) {
+    int games = worker->games;
+    TetrisEnv env(games, TetrisEnv::BIT_PACKED);
+
+    // Per-step buffers, allocated once.
+    std::vector<uint32_t> seeds(games);
+    std::vector<uint8_t> observations(games*env.observation_size());
+    std::vector<int32_t> actions(games);
+    std::vector<float> rewards(games);
+    std::vector<uint8_t> dones(games);
+    std::vector<int64_t> current_score(games);
+    std::vector<int32_t> bot(games);
+    std::vector<int32_t> games_played(games);
+    std::vector<int64_t> total_score(games);
+    uint64_t placements = 0;
+    Board scratch;
+
+    for (int g = 0; g < games; g++) {
+        seeds[g] = worker->first_game + g + 1;
+        bot[g] = (worker->first_game + g) % NUM_BOTS;
+    }
+    env.reset(&seeds[0], &observations[0]);
+
+    std::chrono::steady_clock::time_point last_publish;
+    while (running.load(std::memory_order_relaxed)) {
+        for (int g = 0; g < games; g++)
+            actions[g] = choose_action(env.games(), g, BOTS[bot[g]], &scratch);
+        env.step(&actions[0], &observations[0], &rewards[0], &dones[0]);
+        placements += games;
+
+        for (int g = 0; g < games; g++) {
+            current_score[g] += static_cast<int64_t>(rewards[g]);
+            if (dones[g]) {
+                games_played[g]++;
+                total_score[g] += current_score[g];
+                current_score[g] = 0;
+            }
+        }
+
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        if (now - last_publish < PUBLISH_INTERVAL)
+            continue;
+        last_publish = now;
+
+        // Vectors keep their capacity, so after the first rounds this
+        // only copies.
+        TournamentSnapshot& snapshot = worker->snapshots.write_buffer();
+        snapshot.games = env.games();
+        snapshot.bot = bot;
+        snapshot.games_played = games_played;
+        snapshot.total_score = total_score;
+        snapshot.placements = placements;
+        worker->snapshots.publish();
+    }
+}
@@ -0,0 +1,60 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_TOURNAMENT_H_
+#define SRC_TOURNAMENT_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "src/board_batch.h"
+#include "src/triple_buffer.h"
+
+// What a simulation thread last published about its games.
+struct TournamentSnapshot {
+    BoardBatch games;
+    std::vector<int32_t> bot;  // Contestant playing each game, see BOTS.
+    std::vector<int32_t> games_played;  // Finished games per slot.
+    std::vector<int64_t> total_score;  // Over finished games, per slot.
+    uint64_t placements;  // Pieces placed by the thread so far.
+
+    TournamentSnapshot() : games(0), placements(0) { }
+};
+
+// Plays many bot games on background threads, each thread stepping its
+// share of the games with a TetrisEnv as fast as it can. Threads publish
+// snapshots through triple buffers, so a viewer reading them never blocks
+// the simulation.
+class Tournament {
+ public:
+    Tournament(int games, int threads);
+    ~Tournament();
+
+    void start();
+    void stop();
+
+    int workers() const { return static_cast<int>(pool.size()); }
+
+    // Latest snapshot of a thread. Only one (viewer) thread may call this.
+    const TournamentSnapshot& snapshot(int worker);
+
+ private:
+    Tournament(const Tournament&);
+    Tournament& operator=(const Tournament&);
+
+    struct Worker {
+        int first_game;
+        int games;
+        TripleBuffer<TournamentSnapshot> snapshots;
+    };
+
+    void run(Worker* worker);
+
+    std::vector<Worker*> pool;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running;
+};
+
+#endif  // SRC_TOURNAMENT_H_
@@ -0,0 +1,51 @@
+// Copyright [2015] <Chafic Najjar>
+
+#ifndef SRC_TRIPLE_BUFFER_H_
+#define SRC_TRIPLE_BUFFER_H_
+
+#include <atomic>
+
+// Hands snapshots from one producer thread to one consumer thread without
+// locks. The producer fills write_buffer() and publishes it; the consumer
+// picks up the latest published snapshot with update() and reads it from
+// read_buffer(). Neither side ever waits for the other: the producer
+// always has a free slot and the consumer keeps the last snapshot until a
+// newer one arrives.
+template <typename T>
+class TripleBuffer {
+ public:
+    TripleBuffer() : back(0), middle(1), front(2) { }
+
+    // Producer side.
+    T& write_buffer() { return slots[back]; }
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel)
+            & INDEX;
+    }
+
+    // Consumer side. Returns true if a newer snapshot was picked up.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& read_buffer() const { return slots[front]; }
+
+    // All slots, e.g. to size them before the producer starts.
+    T& slot(int i) { return slots[i]; }
+
+ private:
+    TripleBuffer(const TripleBuffer&);
+    TripleBuffer& operator=(const TripleBuffer&);
+
+    static const int INDEX = 3;
+    static const int FRESH = 4;  // Set while middle holds an unread slot.
+
+    T slots[3];
+    int back;  // Only touched by the producer.
+    std::atomic<int> middle;  // Slot index, plus FRESH.
+    int front;  // Only touched by the consumer.
+};
+
+#endif  // SRC_TRIPLE_BUFFER_H_
@@ -2,9 +2,12 @@
 
 #include "src/utilities.h"
 
+#include "src/profiler.h"
+
 void render_texture(SDL_Texture *tex,
         SDL_Renderer* ren, SDL_Rect dst, SDL_Rect* clip) {
     SDL_RenderCopy(ren, tex, clip, &dst);
+    FrameProfiler::count_draw_calls();
 }
 
 void render_texture(SDL_Texture* tex,
@@ -0,0 +1,58 @@
+// Compares two checksum streams written with --checksums.
+// Copyright [2015] <Chafic Najjar>
+//
+// Usage: checksum_diff <a> <b>
+//
+// Reports the first tick where the runs differ. Exits with 0 if both
+// streams are identical, 1 if they differ and 2 on read errors.
+
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+#include "src/checksum.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <a> <b>\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<TickChecksum> a, b;
+    for (int i = 1; i <= 2; i++)
+        if (!read_checksums(argv[i], i == 1 ? &a : &b)) {
+            std::fprintf(stderr, "cannot read checksums from %s\n", argv[i]);
+            return 2;
+        }
+
+    size_t n = a.size() < b.size() ? a.size() : b.size();
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] == b[i])
+            continue;
+
+        std::printf("first difference at tick %" PRIu32 " (line %zu):\n",
+                a[i].tick, i + 1);
+        if (a[i].tick != b[i].tick)
+            std::printf("  tick:  %" PRIu32 " != %" PRIu32 "\n",
+                    a[i].tick, b[i].tick);
+        if (a[i].board != b[i].board)
+            std::printf("  board: %016" PRIx64 " != %016" PRIx64 "\n",
+                    a[i].board, b[i].board);
+        if (a[i].piece != b[i].piece)
+            std::printf("  piece: %016" PRIx64 " != %016" PRIx64 "\n",
+                    a[i].piece, b[i].piece);
+        if (a[i].score != b[i].score)
+            std::printf("  score: %" PRId32 " != %" PRId32 "\n",
+                    a[i].score, b[i].score);
+        return 1;
+    }
+
+    if (a.size() != b.size()) {
+        std::printf("streams agree for %zu ticks, then %s ends\n",
+                n, a.size() < b.size() ? argv[1] : argv[2]);
+        return 1;
+    }
+
+    std::printf("identical (%zu ticks)\n", n);
+    return 0;
+}
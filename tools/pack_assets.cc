@@ -0,0 +1,144 @@
+// Packs resource files into one asset pack, see src/asset_pack.h.
+// Copyright [2015] <Chafic Najjar>
+//
+// Usage: pack_assets [--decode-images] <output> <file>...
+//
+// Files are stored under the path given on the command line, which is the
+// path the game opens them with, e.g. resources/fonts/bitwise.ttf. With
+// --decode-images, PNG, BMP and GIF files are stored decoded to ARGB8888
+// so the game uploads them without decoding.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "src/asset_pack.h"
+
+namespace {
+    struct Input {
+        AssetPack::Entry entry;
+        std::vector<char> bytes;
+    };
+
+    bool is_image(const std::string& path) {
+        std::string::size_type dot = path.rfind('.');
+        if (dot == std::string::npos)
+            return false;
+        std::string ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext == "png" || ext == "bmp" || ext == "gif";
+    }
+
+    bool read_file(const std::string& path, std::vector<char>* bytes) {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file)
+            return false;
+        bytes->assign(std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>());
+        return !file.bad();
+    }
+
+    // Decodes an image into tightly packed ARGB8888 rows.
+    bool decode_image(const std::string& path, Input* input) {
+        SDL_Surface* image = IMG_Load(path.c_str());
+        if (image == nullptr)
+            return false;
+        SDL_Surface* argb = SDL_ConvertSurfaceFormat(image,
+                SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(image);
+        if (argb == nullptr)
+            return false;
+
+        int pitch = argb->w*4;
+        input->bytes.resize(pitch*argb->h);
+        for (int y = 0; y < argb->h; y++)
+            std::memcpy(&input->bytes[y*pitch],
+                    static_cast<char*>(argb->pixels) + y*argb->pitch, pitch);
+        input->entry.format = AssetPack::ARGB8888;
+        input->entry.width = argb->w;
+        input->entry.height = argb->h;
+        input->entry.pitch = pitch;
+        SDL_FreeSurface(argb);
+        return true;
+    }
+
+    bool by_path(const Input& a, const Input& b) {
+        return std::strcmp(a.entry.path, b.entry.path) < 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int first = 1;
+    bool decode = argc > 1 && std::strcmp(argv[1], "--decode-images") == 0;
+    if (decode)
+        first++;
+    if (argc - first < 2) {
+        std::fprintf(stderr,
+                "usage: %s [--decode-images] <output> <file>...\n", argv[0]);
+        return 1;
+    }
+    const char* output = argv[first];
+
+    std::vector<Input> inputs;
+    for (int i = first + 1; i < argc; i++) {
+        std::string path = argv[i];
+        if (path.size() >= AssetPack::PATH_SIZE) {
+            std::fprintf(stderr, "path too long: %s\n", path.c_str());
+            return 1;
+        }
+
+        Input input;
+        std::memset(&input.entry, 0, sizeof(input.entry));
+        std::strcpy(input.entry.path, path.c_str());
+        input.entry.format = AssetPack::RAW;
+        bool ok = decode && is_image(path) ? decode_image(path, &input) :
+            read_file(path, &input.bytes);
+        if (!ok) {
+            std::fprintf(stderr, "cannot read %s\n", path.c_str());
+            return 1;
+        }
+        inputs.push_back(input);
+    }
+    std::sort(inputs.begin(), inputs.end(), by_path);
+
+    // Lay the data out after the index.
+    AssetPack::Header header = { AssetPack::MAGIC, AssetPack::VERSION,
+        static_cast<uint32_t>(inputs.size()), 0 };
+    uint64_t offset = sizeof(header) + inputs.size()*sizeof(AssetPack::Entry);
+    for (size_t i = 0; i < inputs.size(); i++) {
+        offset = (offset + AssetPack::ALIGNMENT - 1) &
+            ~static_cast<uint64_t>(AssetPack::ALIGNMENT - 1);
+        inputs[i].entry.offset = offset;
+        inputs[i].entry.size = inputs[i].bytes.size();
+        offset += inputs[i].bytes.size();
+    }
+
+    std::ofstream file(output, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t i = 0; i < inputs.size(); i++)
+        file.write(reinterpret_cast<const char*>(&inputs[i].entry),
+                sizeof(inputs[i].entry));
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const AssetPack::Entry& entry = inputs[i].entry;
+        while (static_cast<uint64_t>(file.tellp()) < entry.offset)
+            file.put('\0');
+        if (!inputs[i].bytes.empty())
+            file.write(&inputs[i].bytes[0], inputs[i].bytes.size());
+    }
+    if (!file) {
+        std::fprintf(stderr, "cannot write %s\n", output);
+        return 1;
+    }
+
+    std::printf("%zu files, %llu bytes\n", inputs.size(),
+            static_cast<unsigned long long>(offset));
+    return 0;
+}
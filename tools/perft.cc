@@ -0,0 +1,122 @@
+// Counts reachable lock positions, like perft in chess engines.
+// Copyright [2015] <Chafic Najjar>
+//
+// Usage: perft <depth> <pieces> [board file]
+//
+// pieces is a sequence of tetromino letters (Z, J, O, T, S, I, L), used
+// cyclically when shorter than depth. The optional board file holds
+// Board::ROWS lines of Board::COLS characters: '.' for an empty block,
+// a digit for a block of that tetromino type, anything else for a block
+// of type 0. Prints the number of positions at every depth and the
+// move generation throughput.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "src/tetromino.h"
+#include "src/board.h"
+#include "src/movegen.h"
+
+namespace {
+    const char PIECES[] = "ZJOTSIL";  // Indexed by tetromino type.
+
+    const int MAX_DEPTH = 16;
+
+    std::string sequence;
+    long long counts[MAX_DEPTH + 1];
+    long long game_overs;
+
+    void perft(const Board& board, int depth, int max_depth) {
+        counts[depth]++;
+        if (depth == max_depth)
+            return;
+
+        int type = sequence[depth % sequence.size()];
+        Placement placements[MAX_PLACEMENTS];
+        int n = generate_placements(board, type, placements);
+        for (int i = 0; i < n; i++) {
+            Board child = board;
+            if (!apply_placement(&child, type, placements[i])) {
+                // Topped out: reached, but no further pieces.
+                counts[depth + 1]++;
+                game_overs++;
+                continue;
+            }
+            perft(child, depth + 1, max_depth);
+        }
+    }
+
+    bool load_board(const char* path, Board* board) {
+        std::ifstream file(path);
+        std::string line;
+        for (int i = 0; i < Board::ROWS; i++) {
+            if (!std::getline(file, line) ||
+                    static_cast<int>(line.size()) < Board::COLS)
+                return false;
+            for (int j = 0; j < Board::COLS; j++) {
+                char c = line[j];
+                if (c == '.')
+                    board->color[i][j] = -1;
+                else if (c >= '0' && c <= '6')
+                    board->color[i][j] = c - '0';
+                else
+                    board->color[i][j] = 0;
+            }
+        }
+        board->rehash();
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0]
+            << " <depth> <pieces> [board file]" << std::endl;
+        return 1;
+    }
+
+    int depth = std::atoi(argv[1]);
+    if (depth < 0 || depth > MAX_DEPTH) {
+        std::cerr << "depth must be between 0 and " << MAX_DEPTH << std::endl;
+        return 1;
+    }
+
+    for (const char* p = argv[2]; *p; p++) {
+        const char* found = std::strchr(PIECES, *p & ~0x20);
+        if (found == nullptr || *found == '\0') {
+            std::cerr << "unknown piece '" << *p << "'" << std::endl;
+            return 1;
+        }
+        sequence += static_cast<char>(found - PIECES);
+    }
+    if (sequence.empty()) {
+        std::cerr << "empty piece sequence" << std::endl;
+        return 1;
+    }
+
+    Board board;
+    if (argc > 3 && !load_board(argv[3], &board)) {
+        std::cerr << "cannot read board from " << argv[3] << std::endl;
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    perft(board, 0, depth);
+    double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    long long nodes = 0;
+    for (int d = 0; d <= depth; d++) {
+        std::cout << "depth " << d << ": " << counts[d] << std::endl;
+        nodes += counts[d];
+    }
+    std::cout << "game overs: " << game_overs << std::endl;
+    std::cout << "nodes: " << nodes << " in " << seconds << " s ("
+        << static_cast<long long>(seconds > 0 ? nodes / seconds : 0)
+        << " nodes/s)" << std::endl;
+}
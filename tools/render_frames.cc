@@ -0,0 +1,130 @@
+// Renders bot gameplay to images without a window or GPU.
+// Copyright [2015] <Chafic Najjar>
+//
+// Usage: render_frames <frames> <output> [seed]
+//
+// Plays one game with the "balanced" bot, one gravity step per frame, and
+// draws every frame with SoftwareRenderer. If output ends in ".png" it is
+// a pattern for one image per frame (e.g. out/%06d.png, with one %d as in
+// FrameCapture::frame_path); otherwise
+// raw RGBA frames of 500x640 are appended to it, "-" meaning stdout, e.g.
+//
+//   render_frames 3600 - |
+//       ffmpeg -f rawvideo -pix_fmt rgba -s 500x640 -r 60 -i - game.mp4
+//
+// The same seed gives the same images, for golden-image tests.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "src/board_batch.h"
+#include "src/bot.h"
+#include "src/frame_capture.h"
+#include "src/play_frame.h"
+#include "src/soft_renderer.h"
+
+namespace {
+    bool ends_with(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() &&
+            s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Turns and moves the new piece of game 0 to where the bot wants it;
+    // gravity then takes it down.
+    void aim(BoardBatch* batch, Board* scratch) {
+        int action = choose_action(*batch, 0, BOTS[0], scratch);
+        batch->rotate(0, action / BoardBatch::COLS);
+        int target = action % BoardBatch::COLS;
+        while (batch->x[0] != target &&
+                batch->shift(0, target < batch->x[0] ? -1 : 1)) { }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::fprintf(stderr, "usage: %s <frames> <output> [seed]\n",
+                argv[0]);
+        return 2;
+    }
+    int frames = std::atoi(argv[1]);
+    std::string output = argv[2];
+    uint32_t seed = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1;
+    bool png = ends_with(output, ".png");
+    std::string path;
+    if (png && !FrameCapture::frame_path(output, 0, &path)) {
+        std::fprintf(stderr, "frame pattern %s needs exactly one %%d\n",
+                output.c_str());
+        return 2;
+    }
+
+    // No video subsystem: surfaces, SDL_image and SDL_ttf only.
+    if (SDL_Init(0) != 0 || TTF_Init() != 0) {
+        std::fprintf(stderr, "cannot initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    SoftwareRenderer renderer;
+    if (!renderer.init())
+        return 2;
+
+    FILE* raw = nullptr;
+    if (!png) {
+        raw = output == "-" ? stdout : std::fopen(output.c_str(), "wb");
+        if (raw == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", output.c_str());
+            return 2;
+        }
+    }
+
+    BoardBatch batch(1);
+    batch.reset(0, seed);
+    Board scratch;
+    PlayFrame frame;
+    aim(&batch, &scratch);
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    bool ok = true;
+    for (int i = 0; ok && i < frames; i++) {
+        make_frame(batch, 0, &frame);
+        renderer.render(frame);
+
+        if (png) {
+            FrameCapture::frame_path(output, i, &path);
+            ok = renderer.save_png(path);
+        } else {
+            ok = renderer.write_raw(raw);
+        }
+
+        // A new game starts right after a game over.
+        if (batch.game_over[0]) {
+            seed = seed*1664525u + 1013904223u;
+            batch.reset(0, seed);
+            aim(&batch, &scratch);
+        } else if (batch.tick()) {
+            aim(&batch, &scratch);
+        }
+    }
+    if (raw != nullptr && raw != stdout)
+        std::fclose(raw);
+    if (!ok) {
+        std::fprintf(stderr, "cannot write %s: %s\n", output.c_str(),
+                SDL_GetError());
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%d frames in %.2f s (%.0f frames/s)\n",
+            frames, seconds, frames / seconds);
+
+    renderer.destroy();
+    TTF_Quit();
+    SDL_Quit();
+    return 0;
+}